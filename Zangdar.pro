@@ -18,6 +18,11 @@ DEFINES += HOME='\\"$${HOME_STR}\\"'
 
 #------------------------------------------------------
 
+# réseau de neurones inclus dans l'exécutable (voir NNUE.cpp)
+# DEFINES += NNUE_EMBEDDED='\\"$${HOME_STR}networks/default.nnue\\"'
+
+#------------------------------------------------------
+
 # DEFINES += USE_TUNER
 # QMAKE_CXXFLAGS_RELEASE += -fopenmp
 # LIBS += -fopenmp
@@ -156,9 +161,13 @@ HEADERS += \
     src/Bitboard.h \
     src/Board.h \
     src/Move.h \
+    src/Material.h \
     src/MoveList.h \
     src/MovePicker.h \
+    src/NNUE.h \
     src/OrderInfo.h \
+    src/PawnCache.h \
+    src/PerftTable.h \
     src/PolyBook.h \
     src/Search.h \
     src/Square.h \
@@ -180,9 +189,13 @@ HEADERS += \
 SOURCES += \
     src/Attacks.cpp \
     src/Board.cpp \
+    src/Material.cpp \
     src/MoveList.cpp \
     src/MovePicker.cpp \
+    src/NNUE.cpp \
     src/OrderInfo.cpp \
+    src/PawnCache.cpp \
+    src/PerftTable.cpp \
     src/PolyBook.cpp \
     src/Search.cpp \
     src/ThreadPool.cpp \
@@ -192,10 +205,14 @@ SOURCES += \
     src/Uci.cpp \
     src/add_moves.cpp \
     src/attackers.cpp \
+    src/bitbase.cpp \
     src/bitmask.cpp \
+    src/endgame.cpp \
     src/evaluate.cpp \
     src/fen.cpp \
+    src/legal_checks.cpp \
     src/legal_evasions.cpp \
+    src/legality.cpp \
     src/legal_moves.cpp \
     src/legal_noisy.cpp \
     src/legal_quiet.cpp \
@@ -112,12 +112,14 @@ void Board::clear() noexcept
     gamemove_counter = 0;
     hash             = 0;
     pawn_hash        = 0;
+    psqt             = 0;
+    mat_key          = 0;
 
     ep_square    = NO_SQUARE;
     castling     = CASTLE_NONE;
     side_to_move = Color::WHITE;
     
-    game_history.fill(UndoInfo{0, 0, 0, 0, 0, 0});
+    game_history.fill(UndoInfo{0, 0, 0, 0, 0, 0, 0, 0});
 }
 
 //==========================================================
@@ -13,6 +13,12 @@
 #include "evaluate.h"
 #include "Attacks.h"
 
+class PawnCache;
+class PerftTable;
+#include "Material.h"
+
+class AccumulatorStack;
+
 
 // structure destinée à stocker l'historique de make_move.
 // celle-ci sera nécessaire pour effectuer un unmake_move
@@ -24,6 +30,8 @@ struct UndoInfo
     int  ep_square;              // case en-passant : si les blancs jouent e2-e4, la case est e3
     int  halfmove_counter = 0;   // nombre de coups depuis une capture, ou un movement de pion
     U32  castling;               // droit au roque
+    Score psqt;                  // matériel et position
+    U64  mat_key;                // signature du matériel
 };
 
 //=================================== evaluation
@@ -176,6 +184,12 @@ public:
     template<Color C> constexpr void legal_noisy(MoveList &ml) noexcept;
     template<Color C> constexpr void legal_quiet(MoveList &ml) noexcept;
     template<Color C> constexpr void legal_evasions(MoveList &ml) noexcept;
+    template<Color C> constexpr void legal_quiet_checks(MoveList &ml) noexcept;
+
+    //! \brief  Détermine si un coup (table, killer, counter) est pseudo-légal
+    template<Color C> [[nodiscard]] bool is_pseudo_legal(const MOVE move) const noexcept;
+    //! \brief  Détermine si un coup pseudo-légal laisse le roi hors d'échec
+    template<Color C> [[nodiscard]] bool is_legal(const MOVE move) const noexcept;
 
     template<Color C> void apply_token(const std::string &token) noexcept;
 
@@ -209,6 +223,8 @@ public:
 
     template<Color C> [[nodiscard]] std::uint64_t perft(const int depth) noexcept;
     template<Color C> [[nodiscard]] std::uint64_t divide(const int depth) noexcept;
+    template<Color C> [[nodiscard]] std::uint64_t perft_hash(const int depth, PerftTable& table) noexcept;
+    template<Color C> [[nodiscard]] std::uint64_t perft_threads(const int depth, const int nbr_threads, PerftTable& table) const;
 
     template<Color C> [[nodiscard]] constexpr bool can_castle() const noexcept
     {
@@ -380,6 +396,18 @@ public:
     [[nodiscard]] constexpr std::uint64_t get_hash() const noexcept { return hash; }
     [[nodiscard]] constexpr std::uint64_t get_pawn_hash() const noexcept { return pawn_hash; }
 
+    //! \brief  Table des pions utilisée par l'évaluation
+    //! nullptr : pas de table, l'évaluation des pions est toujours calculée
+    void set_pawn_cache(PawnCache* cache) noexcept { pawn_cache = cache; }
+
+    //! \brief  Table du matériel utilisée par l'évaluation
+    //! nullptr : pas de table, les données du matériel sont toujours calculées
+    void set_material_cache(MaterialCache* cache) noexcept { material_cache = cache; }
+
+    //! \brief  Pile des accumulateurs du réseau de neurones
+    //! nullptr : pas de mise à jour incrémentale
+    void set_accumulators(AccumulatorStack* stack) noexcept { accumulators = stack; }
+
     bool valid() const noexcept;
     [[nodiscard]] std::string display() const noexcept;
 
@@ -400,6 +428,7 @@ public:
     }
 
     Score evaluate();
+    Score evaluate_nnue();
     Score evaluate_pieces(EvalInfo& ei);
 
     template <Color C> Score evaluate_pawns(EvalInfo& ei);
@@ -416,12 +445,23 @@ public:
     Score evaluate_closedness(EvalInfo& ei);
     Score evaluate_complexity(EvalInfo& ei, Score eval);
 
-    int   scale_factor(const Score eval);
+    int   scale_factor(const MaterialEntry* me, const Score eval);
     void  init_eval_info(EvalInfo& ei);
     Score probe_pawn_cache(EvalInfo& ei);
 
     bool material_draw(void);
 
+    U64   material_key() const noexcept;
+    void  calculate_psqt(Score& score, U64& key) const noexcept;
+    void  compute_material(U64 key, MaterialEntry& me);
+    const MaterialEntry* probe_material(MaterialEntry& local);
+    int   evaluate_endgame(const MaterialEntry* me);
+
+    template <Color S> int evaluate_KXK();
+    template <Color S> int evaluate_KBNK();
+    template <Color S> int evaluate_KPK();
+    template <Color S> int evaluate_KRKP();
+
     bool fast_see(const MOVE move, const int threshold) const;
     void test_value(const std::string& fen );
 
@@ -473,6 +513,9 @@ public:
         colorPiecesBB[s] |= BB::sq2BB(sq);
         typePiecesBB[p]  |= BB::sq2BB(sq);
         pieceOn[sq] = p;
+        psqt += psqt_value(s, p, sq);
+        if (p != KING)
+            mat_key += material_unit(s, p);
     }
 
     bool test_mirror(const std::string &line);
@@ -493,6 +536,7 @@ public:
     bool probe_wdl(int &score, int &bound, int ply) const;
     MOVE convertPyrrhicMove(unsigned result) const;
     bool probe_root(MOVE& move) const;
+    bool probe_root_ranks(std::vector<RootMove>& root_moves) const;
 
     //------------------------------------------------------------attackers
     template <Color C> Bitboard discoveredAttacks(int sq);
@@ -528,6 +572,13 @@ public:
     U64 hash           = 0ULL;  // nombre unique (?) correspondant à la position (clef Zobrist)
     U64 pawn_hash      = 0ULL;  // hash uniquement pour les pions
 
+    Score psqt         = 0;     // matériel et position, du point de vue des Blancs (incrémental)
+    U64   mat_key      = 0ULL;  // signature du matériel (incrémentale, voir material_unit)
+
+    PawnCache*     pawn_cache     = nullptr;    // table des pions de la thread
+    MaterialCache* material_cache = nullptr;    // table du matériel de la thread
+    AccumulatorStack* accumulators = nullptr;   // accumulateurs du réseau de la thread
+
     std::vector<std::string> best_moves;  // meilleur coup (pour les test tactique)
     std::vector<std::string> avoid_moves; // coup à éviter (pour les test tactique)
 
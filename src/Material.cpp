@@ -0,0 +1,45 @@
+#include "Material.h"
+
+
+//========================================================
+//! \brief  Constructeur
+//! La table n'est allouée que par "init"
+//--------------------------------------------------------
+MaterialCache::MaterialCache() :
+    entries(nullptr)
+{
+}
+
+//========================================================
+//! \brief  Destructeur
+//--------------------------------------------------------
+MaterialCache::~MaterialCache()
+{
+    delete [] entries;
+}
+
+//========================================================
+//! \brief  Allocation de la table
+//--------------------------------------------------------
+void MaterialCache::init()
+{
+    if (entries != nullptr)
+        return;
+
+    entries = new MaterialEntry[MATERIAL_HASH_SIZE];
+    clear();
+}
+
+//========================================================
+//! \brief  Remise à zéro de la table
+//! La clef nulle est celle de la position Roi contre Roi :
+//! on utilise donc une clef impossible.
+//--------------------------------------------------------
+void MaterialCache::clear()
+{
+    if (entries == nullptr)
+        return;
+
+    for (int i = 0; i < MATERIAL_HASH_SIZE; i++)
+        entries[i].key = ~0ULL;
+}
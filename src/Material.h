@@ -0,0 +1,79 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+class MaterialCache;
+
+#include "defines.h"
+#include "types.h"
+
+//----------------------------------------------------------
+//  Table du matériel
+//
+//  La clef est la "signature" du matériel : le nombre de pièces
+//  de chaque type et de chaque couleur (voir Board::material_key).
+//  Tout ce qui ne dépend que du matériel est calculé une seule
+//  fois par signature (voir Board::compute_material) :
+//  phase, déséquilibre, facteur d'échelle, nullité, et
+//  choix d'un évaluateur spécialisé pour les finales connues.
+
+//! \brief  Incrément de la signature pour une pièce
+//! 4 bits par couleur et type de pièce (hors roi)
+constexpr U64 material_unit(Color c, int piece)
+{
+    return 1ULL << (4 * (5*c + piece - PAWN));
+}
+
+// Evaluateurs spécialisés (voir endgame.cpp)
+enum EndgameType : U08 {
+    EG_NONE = 0,
+    EG_KXK,         // matériel suffisant pour mater le roi seul
+    EG_KBNK,        // fou + cavalier contre roi seul
+    EG_KPK,         // pion contre roi seul (bitbase)
+    EG_KRKP         // tour contre pion
+};
+
+struct MaterialEntry {
+    U64   key;
+    Score imbalance;            // termes ne dépendant que du matériel
+    int   phase24;
+    int   scale[N_COLORS];      // facteur d'échelle, selon le camp le plus fort
+    bool  ocb;                  // un fou de chaque côté, et rien d'autre : vérifier leurs couleurs
+    bool  draw;                 // nullité par manque de matériel
+    U08   endgame;              // évaluateur spécialisé (EndgameType)
+    Color strong;               // camp le plus fort, pour l'évaluateur spécialisé
+};
+
+//----------------------------------------------------------
+//  Chaque thread possède sa propre table (voir ThreadData)
+
+class MaterialCache
+{
+public:
+    MaterialCache();
+    ~MaterialCache();
+
+    void init();
+    void clear();
+
+    //! \brief  Retourne l'entrée correspondant à "key"
+    //! Son contenu n'est valide que si entry->key == key
+    MaterialEntry* entry(U64 key) { return entries + ((key * 0x9E3779B97F4A7C15ULL) >> (64 - MATERIAL_HASH_BITS)); }
+
+private:
+    static constexpr int MATERIAL_HASH_BITS = 13;
+    static constexpr int MATERIAL_HASH_SIZE = 1 << MATERIAL_HASH_BITS;
+
+    MaterialEntry*  entries = nullptr;
+};
+
+//----------------------------------------------------------
+//  Bitbase Roi + Pion contre Roi
+
+namespace Bitbase {
+
+void init();
+bool probe_kpk(int wksq, int wpsq, int bksq, Color stm);
+
+}
+
+#endif // MATERIAL_H
@@ -8,109 +8,22 @@
 //-----------------------------------------------------
 MovePicker::MovePicker(Board* _board, const OrderInfo* _order_info,
                        MOVE _ttMove, MOVE _killer1, MOVE _killer2, MOVE _counter,
+                       MOVE _prev1, MOVE _prev2,
                        bool _skipQuiets, int _threshold) :
     board(_board),
     order_info(_order_info),
     skipQuiets(_skipQuiets),
     stage(STAGE_TABLE),
     gen_quiet(false),
-    gen_legal(false),
+    bad_end(0),
     threshold(_threshold),
     tt_move(_ttMove),
     killer1(_killer1),
     killer2(_killer2),
-    counter(_counter)
+    counter(_counter),
+    prev1(_prev1),
+    prev2(_prev2)
 {
-#if 0
-    int nbr_noisy = 0;
-    int nbr_quiet = 0;
-    int nbr_capt = 0;
-    int nbr_promo = 0;
-    int nbr_capt_promo = 0;
-    int nbr_pep = 0;
-
-    if (board->turn() == WHITE)
-    {
-        board->legal_moves<WHITE>(mll);
-        // _board->legal_noisy<WHITE>(mln);
-        // _board->legal_quiet<WHITE>(mlq);
-    }
-    else
-    {
-        board->legal_moves<BLACK>(mll);
-        // _board->legal_noisy<BLACK>(mln);
-        // _board->legal_quiet<BLACK>(mlq);
-    }
-
-    for (int i=0; i<mll.count; i++)
-    {
-
-        if (Move::is_capturing(mll.moves[i]))
-        {
-            if (Move::is_promoting(mll.moves[i]))
-            {
-                nbr_capt_promo++;
-                mln.moves[mln.count++] = mll.moves[i];
-                nbr_noisy++;
-            }
-            else if (!Move::is_promoting(mll.moves[i]))
-            {
-                nbr_capt++;
-                mln.moves[mln.count++] = mll.moves[i];
-                nbr_noisy++;
-            }
-
-        }
-        else if (Move::is_promoting(mll.moves[i]))
-        {
-            nbr_promo++;
-            mln.moves[mln.count++] = mll.moves[i];
-            nbr_noisy++;
-        }
-        else if(Move::is_enpassant(mll.moves[i]))
-        {
-            nbr_pep++;
-            mln.moves[mln.count++] = mll.moves[i];
-            nbr_noisy++;
-        }
-        else
-        {
-            mlq.moves[mlq.count++] = mll.moves[i];
-            nbr_quiet++;
-        }
-    }
-
-    if (mll.count != (nbr_noisy + nbr_quiet))
-    {
-        std::cout << ">>>>>>>>>>> erreur 1 " << std::endl;
-        std::cout << "nbr_noisy =  " << nbr_noisy << std::endl;
-        std::cout << "nbr_capt =  " << nbr_capt << std::endl;
-        std::cout << "nbr_promo =  " << nbr_promo << std::endl;
-        std::cout << "nbr_pep =  " << nbr_pep << std::endl;
-        std::cout << "nbr_noisy =  " << mln.count << std::endl;
-    }
-
-    if (nbr_noisy != (nbr_capt+nbr_capt_promo+nbr_promo+nbr_pep))
-    {
-        std::cout << ">>>>>>>>>>> erreur 2 " << std::endl;
-        std::cout << "nbr_noisy =  " << nbr_noisy << std::endl;
-        std::cout << "nbr_capt =  " << nbr_capt << std::endl;
-        std::cout << "nbr_capt_promo =  " << nbr_capt_promo << std::endl;
-        std::cout << "nbr_promo =  " << nbr_promo << std::endl;
-        std::cout << "nbr_pep =  " << nbr_pep << std::endl;
-        std::cout << "nbr_noisy =  " << mln.count << std::endl;
-    }
-
-
-    if (nbr_noisy != mln.count)
-        std::cout << ">>>>>>>>>>> erreur 3 " << std::endl;
-
-    if (nbr_quiet != mlq.count)
-        std::cout << ">>>>>>>>>>> erreur 4 " << std::endl;
-
-    score_noisy(board);
-    score_quiet(board);
-#endif
 }
 
 
@@ -140,9 +53,9 @@ MOVE MovePicker::next_move()
         // this stage is only a helper. Advance to the next one.
 
         if (board->turn() == WHITE)
-            board->legal_noisy<WHITE>(mln);
+            board->legal_noisy<WHITE>(ml);
         else
-            board->legal_noisy<BLACK>(mln);
+            board->legal_noisy<BLACK>(ml);
 
         score_noisy();
         stage = STAGE_GOOD_NOISY ;
@@ -152,15 +65,16 @@ MOVE MovePicker::next_move()
     case STAGE_GOOD_NOISY:
 
         // Check to see if there are still more noisy moves
-        if (mln.count != 0)
+        // (entre bad_end et la fin de la liste)
+        if (ml.count > bad_end)
         {
-            int  best     = get_best(mln);
-            MOVE bestMove = mln.moves[best];
+            size_t best     = get_best(bad_end, ml.count);
+            MOVE   bestMove = ml.moves[best];
 
             // Don't play the table move twice
             if (bestMove == tt_move)
             {
-                pop_move(mln, best);
+                pop_move(best, ml.count);
                 return next_move();
             }
 
@@ -170,7 +84,7 @@ MOVE MovePicker::next_move()
                 return next_move();
             }
 
-            return pop_move(mln, best);
+            return pop_move(best, ml.count);
         }
 
         if (skipQuiets)
@@ -265,10 +179,12 @@ MOVE MovePicker::next_move()
         {
             if (gen_quiet == false)
             {
+                // les coups tranquilles sont ajoutés à la suite
+                // des mauvaises captures
                 if (board->turn() == WHITE)
-                    board->legal_quiet<WHITE>(mlq);
+                    board->legal_quiet<WHITE>(ml);
                 else
-                    board->legal_quiet<BLACK>(mlq);
+                    board->legal_quiet<BLACK>(ml);
                 gen_quiet = true;
                 score_quiet();
             }
@@ -280,10 +196,10 @@ MOVE MovePicker::next_move()
     case STAGE_QUIET:
 
         // Check to see if there are still more quiet moves
-        if (mlq.count > 0 && !skipQuiets)
+        if (ml.count > bad_end && !skipQuiets)
         {
-            int  best     = get_best(mlq);
-            MOVE bestMove = pop_move(mlq, best);
+            size_t best     = get_best(bad_end, ml.count);
+            MOVE   bestMove = pop_move(best, ml.count);
 
             if (   bestMove == tt_move
                 || bestMove == killer1
@@ -301,10 +217,10 @@ MOVE MovePicker::next_move()
 
     case STAGE_BAD_NOISY:
 
-        if (mlb.count > 0)
+        if (bad_end > 0)
         {
-            int  best     = get_best(mlb);
-            MOVE bestMove = pop_move(mlb, best);
+            size_t best     = get_best(0, bad_end);
+            MOVE   bestMove = pop_move(best, bad_end);
 
             // Don't play the table move twice
             if (   bestMove == tt_move
@@ -336,9 +252,9 @@ void MovePicker::score_noisy()
     MOVE move;
     int  value;
 
-    for (size_t i = 0; i < mln.count; i++)
+    for (size_t i = 0; i < ml.count; i++)
     {
-        move     = mln.moves[i];
+        move     = ml.moves[i];
 
         // Use the standard MVV-LVA
         // PieceType dest_type = board->piece_on(Move::dest(move));  // pièce prise ou promotion
@@ -361,7 +277,9 @@ void MovePicker::score_noisy()
             value = MvvLvaScores[PAWN][PAWN];
                 // eg_value[PAWN] - PAWN;
 
-        mln.values[i] = value;
+        // L'historique des captures départage les coups
+        // ayant à peu près la même valeur MVV-LVA
+        ml.values[i] = value * 1024 + order_info->get_capture_history(board->turn(), move) / 16;
     }
 }
 
@@ -370,20 +288,24 @@ void MovePicker::score_noisy()
 //------------------------------------------------------------------
 void MovePicker::score_quiet()
 {
-    // Use the History score from the Butterfly Bitboards for sorting
-    for (size_t i = 0; i < mlq.count; i++)
-        mlq.values[i] = order_info->get_history(board->turn(), mlq.moves[i]);
+    // Use the History score from the Butterfly Bitboards for sorting,
+    // plus the continuation histories of the last 2 moves
+    const Color color = board->turn();
+    for (size_t i = bad_end; i < ml.count; i++)
+        ml.values[i] = order_info->get_history(color, ml.moves[i])
+                     + order_info->get_continuation(color, prev1, prev2, ml.moves[i]);
 }
 
 //====================================================
 //! \brief  Retourne l'indice du meilleur élément
+//! de la partie [begin, end[ de la liste
 //-----------------------------------------------------
-int MovePicker::get_best(const MoveList& ml)
+size_t MovePicker::get_best(size_t begin, size_t end) const
 {
-    int best_index = 0;
+    size_t best_index = begin;
 
     // Find highest scoring move
-    for (int i = 1; i < ml.count; i++)
+    for (size_t i = begin + 1; i < end; i++)
     {
         if (ml.values[i] > ml.values[best_index])
             best_index = i;
@@ -391,37 +313,32 @@ int MovePicker::get_best(const MoveList& ml)
 
     return best_index;
 }
+
 //========================================================
 //! \brief  Retourne le coup indiqué
-//! puis déplace le dernier élément à la position
-//! du coup indiqué
+//! puis déplace le dernier élément de la partie
+//! à la position du coup indiqué
+//! \param  end     fin de la partie, décrémentée
 //--------------------------------------------------------
-MOVE MovePicker::pop_move(MoveList& ml, int idx)
+MOVE MovePicker::pop_move(size_t idx, size_t& end)
 {
     MOVE temp = ml.moves[idx];
 
-    ml.count--;
-    ml.moves[idx]  = ml.moves[ml.count];
-    ml.values[idx] = ml.values[ml.count];
+    end--;
+    ml.moves[idx]  = ml.moves[end];
+    ml.values[idx] = ml.values[end];
 
     return temp;
 }
 
 //======================================================
-//! \brief  Déplace le coup indiqué dans la liste mlb
-//! Puis enlève le coup de la liste mln
+//! \brief  Range la mauvaise capture indiquée
+//! au début de la liste, à la suite des autres
 //------------------------------------------------------
-void MovePicker::shift_bad(int idx)
+void MovePicker::shift_bad(size_t idx)
 {
-    // Put the bad capture in the "bad" list
-    mlb.moves[mlb.count]  = mln.moves[idx];
-    mlb.values[mlb.count] = mln.values[idx];
-    mlb.count++;
-
-    // put the last good capture here instead
-    mln.count--;
-    mln.moves[idx]  = mln.moves[mln.count];
-    mln.values[idx] = mln.values[mln.count];
+    ml.swap(idx, bad_end);
+    bad_end++;
 }
 
 
@@ -430,24 +347,10 @@ void MovePicker::shift_bad(int idx)
 //------------------------------------------------------------------
 bool MovePicker::is_legal(MOVE move)
 {
-    if (/*move == NULL_MOVE ||*/ move == Move::MOVE_NONE)
-        return false;
-
-    //ZZZZ  Peut-on faire plus rapide ???
-
-    if (gen_legal == false)
-    {
-        if (board->turn() == WHITE)
-            board->legal_moves<WHITE>(mll);
-        else
-            board->legal_moves<BLACK>(mll);
-        gen_legal = true;
-    }
-
-    for (int n=0; n<mll.count; n++)
-        if (mll.moves[n] == move)
-            return true;
-    return false;
+    if (board->turn() == WHITE)
+        return board->is_pseudo_legal<WHITE>(move) && board->is_legal<WHITE>(move);
+    else
+        return board->is_pseudo_legal<BLACK>(move) && board->is_legal<BLACK>(move);
 }
 
 
@@ -46,7 +46,7 @@ public:
 
     MovePicker(Board *_board, const OrderInfo *_order_info, MOVE _ttMove,
                MOVE _killer1, MOVE _killer2,
-               MOVE _counter,
+               MOVE _counter, MOVE _prev1, MOVE _prev2,
                bool _skipQuiets, int _threshold) ;
 
     MOVE next_move();
@@ -56,9 +56,9 @@ public:
     void verify_MvvLva();
 
     void set_skipQuiets(bool f) { skipQuiets = f;}
-    MOVE pop_move(MoveList &ml, int idx);
-    void shift_bad(int idx);
-    int  get_best(const MoveList &ml);
+    MOVE   pop_move(size_t idx, size_t& end);
+    void   shift_bad(size_t idx);
+    size_t get_best(size_t begin, size_t end) const;
     int  get_stage() const { return stage;}
 
 
@@ -72,18 +72,20 @@ private:
     bool                skipQuiets;    // sauter les coups tranquilles ?
     int                 stage;         // étape courante du sélecteur
     bool                gen_quiet;     // a-t-on déjà générer les coups tranquilles ?
-    bool                gen_legal;
+    size_t              bad_end;       // fin des mauvaises captures, au début de la liste
     int                 threshold;
 
     MOVE tt_move;
     MOVE killer1;
     MOVE killer2;
     MOVE counter;
+    MOVE prev1;     // coup précédent (historique de continuation)
+    MOVE prev2;     // coup d'avant
 
-    MoveList mlq;
-    MoveList mln;
-    MoveList mlb;
-    MoveList mll;   // MoveList de tous les coups légaux pour déterminer si un coup est légal
+    // Liste unique, partagée entre les étapes :
+    //  [0, bad_end[           mauvaises captures
+    //  [bad_end, ml.count[    captures restantes, puis coups tranquilles
+    MoveList ml;
 
 
 
@@ -0,0 +1,397 @@
+#include "NNUE.h"
+#include "Board.h"
+#include "Move.h"
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if defined USE_NNUE
+
+//----------------------------------------------------------
+//  Réseau inclus dans l'exécutable
+//  Il suffit de compiler avec NNUE_EMBEDDED="chemin/du/reseau.nnue"
+//  (directive .incbin de l'assembleur GNU).
+
+#if defined NNUE_EMBEDDED
+asm(
+    "    .section .rodata\n"
+    "    .balign 64\n"
+    "    .global zangdar_net_begin\n"
+    "zangdar_net_begin:\n"
+    "    .incbin \"" NNUE_EMBEDDED "\"\n"
+    "    .global zangdar_net_end\n"
+    "zangdar_net_end:\n"
+    "    .previous\n");
+
+extern "C" const char zangdar_net_begin[];
+extern "C" const char zangdar_net_end[];
+#endif
+
+//----------------------------------------------------------
+//  Noyaux vectoriels sur des int16
+//  AVX2 : 16 valeurs ; SSE2 : 8 valeurs ; sinon version scalaire.
+
+namespace {
+
+#if defined(__AVX2__)
+
+using vec_t = __m256i;
+constexpr int VEC_SIZE = 16;
+
+inline vec_t vec_load(const I16* p)             { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+inline void  vec_store(I16* p, vec_t v)         { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+inline vec_t vec_add(vec_t a, vec_t b)          { return _mm256_add_epi16(a, b); }
+inline vec_t vec_sub(vec_t a, vec_t b)          { return _mm256_sub_epi16(a, b); }
+inline vec_t vec_crelu(vec_t a)                 { return _mm256_min_epi16(_mm256_max_epi16(a, _mm256_setzero_si256()),
+                                                                          _mm256_set1_epi16(NNUE_QA)); }
+inline vec_t vec_madd(vec_t a, vec_t b)         { return _mm256_madd_epi16(a, b); }
+inline vec_t vec_add32(vec_t a, vec_t b)        { return _mm256_add_epi32(a, b); }
+inline vec_t vec_zero()                         { return _mm256_setzero_si256(); }
+inline int   vec_hsum32(vec_t v)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+#elif defined(__SSE2__)
+
+using vec_t = __m128i;
+constexpr int VEC_SIZE = 8;
+
+inline vec_t vec_load(const I16* p)             { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void  vec_store(I16* p, vec_t v)         { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+inline vec_t vec_add(vec_t a, vec_t b)          { return _mm_add_epi16(a, b); }
+inline vec_t vec_sub(vec_t a, vec_t b)          { return _mm_sub_epi16(a, b); }
+inline vec_t vec_crelu(vec_t a)                 { return _mm_min_epi16(_mm_max_epi16(a, _mm_setzero_si128()),
+                                                                       _mm_set1_epi16(NNUE_QA)); }
+inline vec_t vec_madd(vec_t a, vec_t b)         { return _mm_madd_epi16(a, b); }
+inline vec_t vec_add32(vec_t a, vec_t b)        { return _mm_add_epi32(a, b); }
+inline vec_t vec_zero()                         { return _mm_setzero_si128(); }
+inline int   vec_hsum32(vec_t s)
+{
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+#endif
+
+//==========================================================
+//! \brief  out = in + somme(add) - somme(sub)
+//! Une seule passe sur l'accumulateur, quel que soit
+//! le nombre de lignes ajoutées ou retirées.
+//----------------------------------------------------------
+void add_sub(const I16* in, I16* out,
+             const I16* const* add, int nadd,
+             const I16* const* sub, int nsub)
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+    for (int i = 0; i < NNUE_HIDDEN; i += VEC_SIZE)
+    {
+        vec_t v = vec_load(in + i);
+        for (int a = 0; a < nadd; a++)
+            v = vec_add(v, vec_load(add[a] + i));
+        for (int s = 0; s < nsub; s++)
+            v = vec_sub(v, vec_load(sub[s] + i));
+        vec_store(out + i, v);
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+    {
+        int v = in[i];
+        for (int a = 0; a < nadd; a++)
+            v += add[a][i];
+        for (int s = 0; s < nsub; s++)
+            v -= sub[s][i];
+        out[i] = static_cast<I16>(v);
+    }
+#endif
+}
+
+//==========================================================
+//! \brief  Somme de CReLU(acc[i]) * weights[i]
+//----------------------------------------------------------
+int crelu_dot(const I16* acc, const I16* weights)
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+    vec_t sum = vec_zero();
+    for (int i = 0; i < NNUE_HIDDEN; i += VEC_SIZE)
+        sum = vec_add32(sum, vec_madd(vec_crelu(vec_load(acc + i)), vec_load(weights + i)));
+    return vec_hsum32(sum);
+#else
+    int sum = 0;
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        sum += std::clamp(static_cast<int>(acc[i]), 0, NNUE_QA) * weights[i];
+    return sum;
+#endif
+}
+
+}
+
+//========================================================
+//! \brief  Constructeur
+//! Le réseau n'est alloué que lors du chargement
+//--------------------------------------------------------
+NNUE::NNUE()
+{
+}
+
+//========================================================
+//! \brief  Destructeur
+//--------------------------------------------------------
+NNUE::~NNUE()
+{
+    delete weights;
+}
+
+//========================================================
+//! \brief  Lecture du réseau à partir d'un fichier
+//! \return false si le fichier n'est pas valide ; le réseau
+//! précédent (ou l'évaluation classique) est alors conservé
+//--------------------------------------------------------
+bool NNUE::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    return read(data.data(), data.size());
+}
+
+//========================================================
+//! \brief  Lecture du réseau inclus dans l'exécutable
+//--------------------------------------------------------
+bool NNUE::load_embedded()
+{
+#if defined NNUE_EMBEDDED
+    return read(zangdar_net_begin, static_cast<std::size_t>(zangdar_net_end - zangdar_net_begin));
+#else
+    return false;
+#endif
+}
+
+//========================================================
+//! \brief  Retour à l'évaluation classique
+//--------------------------------------------------------
+void NNUE::unload()
+{
+    loaded = false;
+}
+
+//========================================================
+//! \brief  Copie des poids
+//! Les fichiers de "bullet" sont complétés jusqu'à un
+//! multiple de 64 octets : on accepte donc un fichier
+//! un peu plus grand que nécessaire, mais pas au-delà
+//! (réseau d'une autre architecture, ou autre fichier).
+//--------------------------------------------------------
+bool NNUE::read(const char* data, std::size_t size)
+{
+    constexpr std::size_t needed = (NNUE_INPUTS * NNUE_HIDDEN + NNUE_HIDDEN + 2 * NNUE_HIDDEN + 1) * sizeof(I16);
+    constexpr std::size_t padded = (needed + 63) / 64 * 64;
+
+    if (size < needed || size > padded)
+        return false;
+
+    if (weights == nullptr)
+        weights = new Weights;
+
+    const char* ptr = data;
+    std::memcpy(weights->feature_weights, ptr, sizeof(weights->feature_weights));  ptr += sizeof(weights->feature_weights);
+    std::memcpy(weights->feature_bias,    ptr, sizeof(weights->feature_bias));     ptr += sizeof(weights->feature_bias);
+    std::memcpy(weights->output_weights,  ptr, sizeof(weights->output_weights));   ptr += sizeof(weights->output_weights);
+    std::memcpy(&weights->output_bias,    ptr, sizeof(weights->output_bias));
+
+    loaded = true;
+    return true;
+}
+
+//========================================================
+//! \brief  Calcul complet d'un accumulateur
+//--------------------------------------------------------
+void NNUE::refresh(const Board& board, Accumulator& acc) const
+{
+    for (Color persp : {WHITE, BLACK})
+    {
+        I16* values = acc.values[persp];
+        std::memcpy(values, weights->feature_bias, sizeof(weights->feature_bias));
+
+        for (Color color : {WHITE, BLACK})
+        {
+            for (int piece = PAWN; piece <= KING; piece++)
+            {
+                Bitboard bb = board.colorPiecesBB[color] & board.typePiecesBB[piece];
+                while (bb)
+                {
+                    const I16* row = feature(persp, color, piece, BB::pop_lsb(bb));
+                    add_sub(values, values, &row, 1, nullptr, 0);
+                }
+            }
+        }
+    }
+    acc.computed = true;
+}
+
+//========================================================
+//! \brief  Mise à jour incrémentale d'un accumulateur
+//! \param[in]  prev    accumulateur de la position précédente
+//! \param[out] acc     accumulateur après le coup "acc.move"
+//--------------------------------------------------------
+void NNUE::update(const Accumulator& prev, Accumulator& acc) const
+{
+    const MOVE move = acc.move;
+
+    if (move == Move::MOVE_NULL)
+    {
+        std::memcpy(acc.values, prev.values, sizeof(acc.values));
+        acc.computed = true;
+        return;
+    }
+
+    const Color us       = acc.side;
+    const Color them     = ~us;
+    const int   from     = Move::from(move);
+    const int   dest     = Move::dest(move);
+    const int   piece    = Move::piece(move);
+    const int   captured = Move::captured(move);
+    const int   moved    = Move::is_promoting(move) ? Move::promotion(move) : piece;
+
+    for (Color persp : {WHITE, BLACK})
+    {
+        const I16* add[2];
+        const I16* sub[2];
+        int nadd = 0, nsub = 0;
+
+        sub[nsub++] = feature(persp, us, piece, from);
+        add[nadd++] = feature(persp, us, moved, dest);
+
+        if (Move::is_castling(move))
+        {
+            bool ksc  = (BB::sq2BB(dest) & FILE_G_BB);
+            int  rfrom = ksc ? ksc_castle_rook_from[us] : qsc_castle_rook_from[us];
+            int  rdest = ksc ? ksc_castle_rook_to[us]   : qsc_castle_rook_to[us];
+            sub[nsub++] = feature(persp, us, ROOK, rfrom);
+            add[nadd++] = feature(persp, us, ROOK, rdest);
+        }
+        else if (Move::is_enpassant(move))
+        {
+            int sq = (us == WHITE) ? SQ::south(dest) : SQ::north(dest);
+            sub[nsub++] = feature(persp, them, PAWN, sq);
+        }
+        else if (captured != NO_TYPE)
+        {
+            sub[nsub++] = feature(persp, them, captured, dest);
+        }
+
+        add_sub(prev.values[persp], acc.values[persp], add, nadd, sub, nsub);
+    }
+    acc.computed = true;
+}
+
+//========================================================
+//! \brief  Evaluation de la position
+//! \return score du point de vue du camp "side", en centipions
+//--------------------------------------------------------
+int NNUE::evaluate(const Accumulator& acc, Color side) const
+{
+    int output = crelu_dot(acc.values[side],  weights->output_weights)
+               + crelu_dot(acc.values[~side], weights->output_weights + NNUE_HIDDEN);
+
+    return (output + weights->output_bias) * NNUE_SCALE / (NNUE_QA * NNUE_QB);
+}
+
+//========================================================
+//! \brief  Constructeur
+//! La pile n'est allouée que par "init"
+//--------------------------------------------------------
+AccumulatorStack::AccumulatorStack()
+{
+}
+
+//========================================================
+//! \brief  Destructeur
+//--------------------------------------------------------
+AccumulatorStack::~AccumulatorStack()
+{
+    delete [] stack;
+}
+
+//========================================================
+//! \brief  Allocation de la pile
+//--------------------------------------------------------
+void AccumulatorStack::init()
+{
+    if (stack != nullptr)
+        return;
+
+    stack = new Accumulator[ACCUMULATOR_STACK_SIZE];
+    top   = 0;
+}
+
+//========================================================
+//! \brief  Calcul de l'accumulateur de la racine
+//--------------------------------------------------------
+void AccumulatorStack::reset(const Board& board)
+{
+    top = 0;
+    nnue.refresh(board, stack[0]);
+}
+
+//========================================================
+//! \brief  Accumulateur de la position courante
+//! On remonte jusqu'au dernier accumulateur à jour,
+//! puis on applique les coups suivants.
+//--------------------------------------------------------
+const Accumulator& AccumulatorStack::current(const Board& board)
+{
+    int i = top;
+    while (i > 0 && !stack[i].computed)
+        i--;
+
+    if (!stack[i].computed)
+    {
+        nnue.refresh(board, stack[top]);
+        return stack[top];
+    }
+
+    for (int j = i + 1; j <= top; j++)
+        nnue.update(stack[j - 1], stack[j]);
+
+    return stack[top];
+}
+
+//========================================================
+//! \brief  Evaluation par le réseau de neurones
+//! \return Evaluation statique de la position
+//! du point de vue du camp au trait.
+//--------------------------------------------------------
+Score Board::evaluate_nnue()
+{
+    int score;
+
+    if (accumulators != nullptr)
+    {
+        score = nnue.evaluate(accumulators->current(*this), side_to_move);
+    }
+    else
+    {
+        // hors recherche : calcul complet
+        Accumulator acc;
+        nnue.refresh(*this, acc);
+        score = nnue.evaluate(acc, side_to_move);
+    }
+
+    // le réseau ne doit pas annoncer de finale gagnée
+    return std::clamp(score, -KNOWN_WIN + 1, KNOWN_WIN - 1);
+}
+
+#endif // USE_NNUE
@@ -0,0 +1,123 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+class NNUE;
+class AccumulatorStack;
+class Board;
+
+#include <string>
+#include <cassert>
+#include "defines.h"
+#include "types.h"
+
+//----------------------------------------------------------
+//  Evaluation par réseau de neurones (NNUE)
+//
+//  Architecture : 768 -> NNUE_HIDDEN (x2) -> 1
+//
+//  Entrées : une par (couleur, pièce, case), vues de chacun des 2 camps
+//  (la "perspective") ; chaque camp se voit comme les Blancs.
+//  La couche cachée (l'accumulateur) est mise à jour de façon
+//  incrémentale : un coup ne modifie que 2 à 4 entrées.
+//  Sortie : CReLU des 2 accumulateurs (camp au trait d'abord),
+//  puis produit scalaire avec les poids de sortie.
+//
+//  Format du fichier (int16, little endian), celui de "bullet" :
+//      poids de l'accumulateur     [768][NNUE_HIDDEN]
+//      biais de l'accumulateur     [NNUE_HIDDEN]
+//      poids de sortie             [2 * NNUE_HIDDEN]
+//      biais de sortie             [1]
+//
+//  Si aucun réseau n'est chargé, on utilise l'évaluation classique.
+
+constexpr int NNUE_INPUTS = 768;
+constexpr int NNUE_HIDDEN = 256;
+constexpr int NNUE_QA     = 255;        // quantification de l'accumulateur
+constexpr int NNUE_QB     = 64;         // quantification des poids de sortie
+constexpr int NNUE_SCALE  = 400;        // conversion de la sortie en centipions
+
+struct alignas(64) Accumulator {
+    I16   values[N_COLORS][NNUE_HIDDEN];    // une moitié par perspective
+    MOVE  move;                             // coup ayant mené à cette position
+    Color side;                             // camp ayant joué ce coup
+    bool  computed;                         // "values" est à jour
+};
+
+//----------------------------------------------------------
+class NNUE
+{
+public:
+    NNUE();
+    ~NNUE();
+
+    bool load(const std::string& path);
+    bool load_embedded();
+    void unload();
+    bool is_loaded() const { return loaded; }
+
+    void refresh(const Board& board, Accumulator& acc) const;
+    void update(const Accumulator& prev, Accumulator& acc) const;
+    int  evaluate(const Accumulator& acc, Color side) const;
+
+private:
+    struct alignas(64) Weights {
+        I16 feature_weights[NNUE_INPUTS * NNUE_HIDDEN];
+        I16 feature_bias[NNUE_HIDDEN];
+        I16 output_weights[2 * NNUE_HIDDEN];
+        I16 output_bias;
+    };
+
+    Weights* weights = nullptr;     // alloué lors du chargement
+    bool     loaded  = false;
+
+    bool read(const char* data, std::size_t size);
+
+    //! \brief  Ligne des poids correspondant à une pièce,
+    //! vue de la perspective "persp"
+    const I16* feature(Color persp, Color color, int piece, int sq) const
+    {
+        int index = (color == persp ? 0 : 384)
+                  + 64 * (piece - PAWN)
+                  + (persp == WHITE ? sq : sq ^ 56);
+        return weights->feature_weights + index * NNUE_HIDDEN;
+    }
+};
+
+extern NNUE nnue;
+
+//----------------------------------------------------------
+//  Pile des accumulateurs d'une thread
+//  make_move empile le coup, undo_move le dépile ; l'accumulateur
+//  n'est calculé que lorsqu'on en a besoin (évaluation), à partir
+//  du dernier accumulateur à jour dans la pile.
+
+constexpr int ACCUMULATOR_STACK_SIZE = MAX_PLY + 8;
+
+class AccumulatorStack
+{
+public:
+    AccumulatorStack();
+    ~AccumulatorStack();
+
+    void init();
+    void reset(const Board& board);
+
+    void push(MOVE move, Color side)
+    {
+        assert(top < ACCUMULATOR_STACK_SIZE - 1);
+        Accumulator& acc = stack[++top];
+        acc.move     = move;
+        acc.side     = side;
+        acc.computed = false;
+    }
+
+    void pop() { top--; }
+
+    const Accumulator& current(const Board& board);
+
+private:
+    Accumulator* stack = nullptr;   // alloué par "init"
+    int          top   = 0;
+};
+
+#endif // NNUE_H
@@ -1,12 +1,46 @@
 #include "OrderInfo.h"
 #include "Move.h"
 #include <cstring>
+#include <cstdlib>
 
 OrderInfo::OrderInfo()
 {
     clear_all();
 }
 
+OrderInfo::~OrderInfo()
+{
+    delete [] continuation;
+}
+
+//=========================================================
+//! \brief  Allocation des historiques de continuation
+//! Ne fait rien s'ils sont déjà alloués
+//---------------------------------------------------------
+void OrderInfo::init()
+{
+    if (continuation == nullptr)
+    {
+        continuation = new ContinuationHistory[2];
+        std::memset(continuation, 0, 2 * sizeof(ContinuationHistory));
+    }
+}
+
+//=========================================================
+//! \brief  Mise à jour d'un historique, borné par HISTORY_MAX :
+//! plus la valeur est grande, moins elle augmente
+//---------------------------------------------------------
+static inline void update_gravity(I16& entry, int bonus)
+{
+    entry += bonus - entry * std::abs(bonus) / OrderInfo::HISTORY_MAX;
+}
+
+//! \brief  Le coup précédent peut-il indexer un historique de continuation ?
+static inline bool is_real_move(MOVE move)
+{
+    return move != Move::MOVE_NONE && move != Move::MOVE_NULL;
+}
+
 //=========================================================
 //! \brief  Re-initialise tous les heuristiques
 //---------------------------------------------------------
@@ -17,6 +51,9 @@ void OrderInfo::clear_all()
     std::memset(history,  0, sizeof(history));
     std::memset(counter,  0, sizeof(counter));
     std::memset(excluded, 0, sizeof(excluded));
+    std::memset(capture_history, 0, sizeof(capture_history));
+    if (continuation != nullptr)
+        std::memset(continuation, 0, 2 * sizeof(ContinuationHistory));
 
 }
 
@@ -42,11 +79,38 @@ void OrderInfo::update_killers(int ply, MOVE move)
 }
 
 //=========================================================
-//! \brief  Incrémente l'heuristique "History"
+//! \brief  Met à jour l'heuristique "History"
+//! \param[in] bonus    positif (bonus) ou négatif (malus)
 //---------------------------------------------------------
 void OrderInfo::update_history(Color color, MOVE move, int bonus)
 {
-    history[color][Move::piece(move)][Move::dest(move)] += bonus;
+    update_gravity(history[color][Move::piece(move)][Move::dest(move)], bonus);
+}
+
+//=================================================================
+//! \brief  Met à jour les historiques des coups tranquilles
+//! après une coupure : bonus pour le coup de la coupure,
+//! malus pour les coups tranquilles essayés avant lui
+//! \param[in] prev1        coup précédent (adversaire)
+//! \param[in] prev2        coup d'avant (même camp)
+//! \param[in] best         coup ayant provoqué la coupure
+//! \param[in] quiets       coups tranquilles joués, dont "best"
+//-----------------------------------------------------------------
+void OrderInfo::update_quiet_histories(Color color, MOVE prev1, MOVE prev2, MOVE best,
+                                       const MOVE* quiets, int nbr_quiets, int depth)
+{
+    const int bonus = history_bonus(depth);
+
+    update_history(color, best, bonus);
+    update_continuation(color, prev1, prev2, best, bonus);
+
+    for (int i = 0; i < nbr_quiets; i++)
+    {
+        if (quiets[i] == best)
+            continue;
+        update_history(color, quiets[i], -bonus);
+        update_continuation(color, prev1, prev2, quiets[i], -bonus);
+    }
 }
 
 //=========================================================
@@ -85,3 +149,52 @@ void OrderInfo::get_refutation_moves(Color color, int ply, MOVE prev_move, MOVE&
     _killer_2 = killer2[ply];
 }
 
+//=================================================================
+//! \brief  Met à jour les historiques de continuation
+//! \param[in] color        couleur du camp qui joue
+//! \param[in] prev1        coup précédent (adversaire)
+//! \param[in] prev2        coup d'avant (même camp)
+//! \param[in] move         coup tranquille ayant provoqué la coupure
+//-----------------------------------------------------------------
+void OrderInfo::update_continuation(Color color, MOVE prev1, MOVE prev2, MOVE move, int bonus)
+{
+    const int piece = Move::piece(move);
+    const int dest  = Move::dest(move);
+
+    if (is_real_move(prev1))
+        update_gravity(continuation[0][color][Move::piece(prev1)][Move::dest(prev1)][piece][dest], bonus);
+    if (is_real_move(prev2))
+        update_gravity(continuation[1][color][Move::piece(prev2)][Move::dest(prev2)][piece][dest], bonus);
+}
+
+//=================================================================
+//! \brief  Somme des historiques de continuation d'un coup
+//-----------------------------------------------------------------
+int OrderInfo::get_continuation(Color color, MOVE prev1, MOVE prev2, MOVE move) const
+{
+    const int piece = Move::piece(move);
+    const int dest  = Move::dest(move);
+    int value = 0;
+
+    if (is_real_move(prev1))
+        value += continuation[0][color][Move::piece(prev1)][Move::dest(prev1)][piece][dest];
+    if (is_real_move(prev2))
+        value += continuation[1][color][Move::piece(prev2)][Move::dest(prev2)][piece][dest];
+    return value;
+}
+
+//=================================================================
+//! \brief  Met à jour l'historique des captures
+//-----------------------------------------------------------------
+void OrderInfo::update_capture_history(Color color, MOVE move, int bonus)
+{
+    update_gravity(capture_history[color][Move::piece(move)][Move::dest(move)][Move::captured(move)], bonus);
+}
+
+//=================================================================
+//! \brief  Récupère l'historique des captures
+//-----------------------------------------------------------------
+int OrderInfo::get_capture_history(Color color, MOVE move) const
+{
+    return capture_history[color][Move::piece(move)][Move::dest(move)][Move::captured(move)];
+}
@@ -5,28 +5,50 @@ class OrderInfo;
 
 #include "defines.h"
 #include "types.h"
+#include <algorithm>
+
+//  Historique de continuation : [couleur][pièce, case du coup précédent][pièce, case du coup]
+using ContinuationHistory = I16[N_COLORS][N_PIECES][N_SQUARES][N_PIECES][N_SQUARES];
 
 //! \brief  Données utilisées au cours de recherche
 class OrderInfo
 {
 public:
     OrderInfo();
+    ~OrderInfo();
+
+    static constexpr int HISTORY_MAX = 16384;       // borne des historiques "gravity"
 
     MOVE   killer1[MAX_PLY+2];                      // killer moves
     MOVE   killer2[MAX_PLY+2];
     MOVE   excluded[MAX_PLY+2];
 
-    int    history[N_COLORS][N_PIECES][N_SQUARES];  // bonus history
+    I16    history[N_COLORS][N_PIECES][N_SQUARES];  // butterfly history
     MOVE   counter[N_COLORS][N_PIECES][N_SQUARES];  // counter move
+    I16    capture_history[N_COLORS][N_PIECES][N_SQUARES][N_PIECES];    // [pièce][case][pièce prise]
+
+    // [0] : coup précédent (1 ply), [1] : coup d'avant (2 plies)
+    ContinuationHistory* continuation = nullptr;    // alloué par "init"
 
+    void init();
     void clear_all();
     void clear_killers();
     void update_killers(int ply, MOVE move);
-    void update_history(Color color, MOVE move, int delta);
+    void update_history(Color color, MOVE move, int bonus);
+    void update_quiet_histories(Color color, MOVE prev1, MOVE prev2, MOVE best,
+                                const MOVE* quiets, int nbr_quiets, int depth);
     int  get_history(const Color color, const MOVE move) const;
     void update_counter(Color color, int ply, MOVE prev_move, MOVE move);
     void get_refutation_moves(Color color, int ply, MOVE prev_move, MOVE& _killer_1, MOVE& _killer_2, MOVE& _counter_move);
 
+    void update_continuation(Color color, MOVE prev1, MOVE prev2, MOVE move, int bonus);
+    int  get_continuation(Color color, MOVE prev1, MOVE prev2, MOVE move) const;
+    void update_capture_history(Color color, MOVE move, int bonus);
+    int  get_capture_history(Color color, MOVE move) const;
+
+    //! \brief  Bonus d'historique pour une coupure à la profondeur "depth"
+    static int history_bonus(int depth) { return std::min(1536, 32 * depth * depth); }
+
 
 }__attribute__((aligned(64)));
 
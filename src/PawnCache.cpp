@@ -0,0 +1,95 @@
+#include <cstring>
+#include "PawnCache.h"
+
+
+//========================================================
+//! \brief  Constructeur
+//! La table n'est allouée que par "init_size"
+//--------------------------------------------------------
+PawnCache::PawnCache() :
+    entries(nullptr),
+    size(0),
+    mask(0),
+    kb(0)
+{
+}
+
+//========================================================
+//! \brief  Destructeur
+//--------------------------------------------------------
+PawnCache::~PawnCache()
+{
+    delete [] entries;
+}
+
+//========================================================
+//! \brief  Allocation de la table
+//! \param[in]  kbsize  taille de la table, en Ko
+//--------------------------------------------------------
+void PawnCache::init_size(int kbsize)
+{
+    // rien à faire si la taille ne change pas
+    if (entries != nullptr && kbsize == kb)
+        return;
+
+    delete [] entries;
+
+    int nbr_elem = static_cast<int>(kbsize * 1024 / sizeof(PawnHashEntry));
+
+    // size must be a power of 2!
+    size = 1;
+    while (size <= nbr_elem)
+        size *= 2;
+    size /= 2;
+
+    kb      = kbsize;
+    mask    = size - 1;
+    entries = new PawnHashEntry[size];
+
+    clear();
+}
+
+//========================================================
+//! \brief  Remise à zéro de la table
+//--------------------------------------------------------
+void PawnCache::clear()
+{
+    if (entries != nullptr)
+        std::memset(entries, 0, sizeof(PawnHashEntry) * size);
+}
+
+//===============================================================
+//! \brief  Recherche d'une donnée dans la table des pions
+//! \param[in]  hash    code hash des pions
+//! \param{out] score   score de cette position
+//! \param[out] passed  bitboard des pions passés
+//---------------------------------------------------------------
+bool PawnCache::probe(U64 hash, Score &eval, Bitboard& passed) const
+{
+    const PawnHashEntry* entry = entries + (hash & mask);
+
+    if (entry->hash == hash)
+    {
+        eval   = entry->eval;
+        passed = entry->passed;
+        return true;
+    }
+
+    return false;
+}
+
+//=============================================================
+//! \brief Stocke une évaluation dans la table des pions
+//!
+//! \param[in]  hash    hash des pions
+//! \param[in]  score   évaluation
+//! \param[in]  passed  bitboard des pions passés
+//-------------------------------------------------------------
+void PawnCache::store(U64 hash, Score eval, Bitboard passed)
+{
+    PawnHashEntry* entry = entries + (hash & mask);
+
+    entry->hash   = hash;
+    entry->eval   = eval;
+    entry->passed = passed;
+}
@@ -0,0 +1,42 @@
+#ifndef PAWNCACHE_H
+#define PAWNCACHE_H
+
+class PawnCache;
+
+#include "defines.h"
+
+//----------------------------------------------------------
+// Code provenant de Ethereal
+
+struct PawnHashEntry {
+    U64      hash;      // 64 bits
+    Bitboard passed;    // 64 bits
+    Score    eval;      // 32 bits
+};
+
+//----------------------------------------------------------
+//  Table des pions
+//  Chaque thread possède sa propre table (voir ThreadData) :
+//  il n'y a donc aucun partage entre les threads, et une
+//  table de petite taille reste dans le cache L2.
+
+class PawnCache
+{
+public:
+    PawnCache();
+    ~PawnCache();
+
+    void init_size(int kbsize);
+    void clear();
+
+    bool probe(U64 hash, Score &eval, Bitboard &passed) const;
+    void store(U64 hash, Score eval, Bitboard passed);
+
+private:
+    PawnHashEntry*  entries = nullptr;
+    int             size;           // nombre d'entrées
+    int             mask;
+    int             kb;             // taille demandée, en Ko
+};
+
+#endif // PAWNCACHE_H
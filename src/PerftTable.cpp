@@ -0,0 +1,111 @@
+#include "PerftTable.h"
+#include "TranspositionTable.h"
+#include <iostream>
+#include <cstdlib>
+
+//========================================================
+//! \brief  Constructeur
+//! La table n'est allouée que par "init_size"
+//--------------------------------------------------------
+PerftTable::PerftTable() :
+    entries(nullptr),
+    size(0),
+    mask(0),
+    mb(0)
+{
+}
+
+//========================================================
+//! \brief  Destructeur
+//--------------------------------------------------------
+PerftTable::~PerftTable()
+{
+    TranspositionTable::free_large(entries);
+}
+
+//========================================================
+//! \brief  Allocation de la table
+//! \param[in]  mbsize  taille de la table, en Mo
+//--------------------------------------------------------
+void PerftTable::init_size(int mbsize)
+{
+    // rien à faire si la taille ne change pas
+    if (entries != nullptr && mbsize == mb)
+        return;
+
+    TranspositionTable::free_large(entries);
+    entries = nullptr;
+
+    U64 nbr_elem = static_cast<U64>(mbsize) * 1024 * 1024 / sizeof(PerftEntry);
+
+    // size must be a power of 2!
+    size = 1;
+    while (size <= nbr_elem)
+        size *= 2;
+    size /= 2;
+
+    // Si la mémoire demandée n'est pas disponible,
+    // on divise la taille par 2 jusqu'à y arriver
+    while (entries == nullptr && size > 1)
+    {
+        entries = static_cast<PerftEntry*>(TranspositionTable::alloc_large(size * sizeof(PerftEntry)));
+        if (entries == nullptr)
+            size /= 2;
+    }
+    if (entries == nullptr)
+    {
+        std::cout << "impossible d'allouer la table du perft" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    mb      = mbsize;
+    mask    = size - 1;
+
+    clear();
+}
+
+//========================================================
+//! \brief  Remise à zéro de la table
+//--------------------------------------------------------
+void PerftTable::clear()
+{
+    for (U64 i = 0; i < size; i++)
+    {
+        entries[i].key.store(0, std::memory_order_relaxed);
+        entries[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+//========================================================
+//! \brief  Recherche du nombre de noeuds d'une position
+//! \param[in]  hash    clef Zobrist de la position
+//! \param[in]  depth   profondeur du perft
+//! \param[out] nodes   nombre de noeuds
+//--------------------------------------------------------
+bool PerftTable::probe(U64 hash, int depth, U64 &nodes) const
+{
+    const PerftEntry& entry = entries[index(hash, depth)];
+
+    const U64 data = entry.data.load(std::memory_order_relaxed);
+    const U64 key  = entry.key.load(std::memory_order_relaxed);
+
+    if ((key ^ data) != hash || static_cast<int>(data & 0xFF) != depth)
+        return false;
+
+    nodes = data >> 8;
+    return true;
+}
+
+//========================================================
+//! \brief  Stockage du nombre de noeuds d'une position
+//! On remplace toujours l'entrée existante.
+//--------------------------------------------------------
+void PerftTable::store(U64 hash, int depth, U64 nodes)
+{
+    PerftEntry& entry = entries[index(hash, depth)];
+
+    const U64 data = (nodes << 8) | static_cast<U64>(depth);
+
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.key.store(hash ^ data, std::memory_order_relaxed);
+}
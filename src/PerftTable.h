@@ -0,0 +1,49 @@
+#ifndef PERFTTABLE_H
+#define PERFTTABLE_H
+
+class PerftTable;
+
+#include <atomic>
+#include "defines.h"
+
+//----------------------------------------------------------
+//  Table de hachage du perft
+//
+//  Une entrée est formée de 2 mots de 64 bits :
+//      data : noeuds 56 | profondeur 8
+//      key  : hash ^ data
+//
+//  Comme pour la table de transposition (voir TranspositionTable.h),
+//  chaque mot est lu et écrit de façon atomique ; une entrée mélangeant
+//  deux écritures concurrentes a une clef fausse, et elle est ignorée.
+//  La table peut donc être partagée par toutes les threads du perft.
+
+struct PerftEntry {
+    std::atomic<U64> key;   // 64 bits
+    std::atomic<U64> data;  // 64 bits
+};
+
+class PerftTable
+{
+public:
+    PerftTable();
+    ~PerftTable();
+
+    void init_size(int mbsize);
+    void clear();
+
+    bool probe(U64 hash, int depth, U64 &nodes) const;
+    void store(U64 hash, int depth, U64 nodes);
+
+private:
+    PerftEntry* entries = nullptr;
+    U64         size;           // nombre d'entrées
+    U64         mask;
+    int         mb;             // taille demandée, en Mo
+
+    //! \brief  Indice de l'entrée : la profondeur est mélangée au hash,
+    //! pour que les différentes profondeurs d'une position ne s'écrasent pas
+    U64 index(U64 hash, int depth) const { return (hash ^ (static_cast<U64>(depth) * 0x9E3779B97F4A7C15ULL)) & mask; }
+};
+
+#endif // PERFTTABLE_H
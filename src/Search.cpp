@@ -34,11 +34,12 @@ Search::~Search() {}
 //=========================================================
 //! \brief  Affichage UCI du résultat de la recherche
 //!
-//! \param[in] depth        profondeur de la recherche
-//! \param[in] best_score   meilleur score
 //! \param[in] elapsed      temps passé pour la recherche, en millisecondes
+//! \param[in] score        score de la ligne
+//! \param[in] pv           variation de la ligne
+//! \param[in] line         numéro de la ligne (MultiPV), à partir de 1
 //---------------------------------------------------------
-void Search::show_uci_result(const ThreadData* td, U64 elapsed, PVariation& pv) const
+void Search::show_uci_result(const ThreadData* td, U64 elapsed, int score, const PVariation& pv, int line) const
 {
     elapsed++; // évite une division par 0
     // commande envoyée à UCI
@@ -70,45 +71,50 @@ void Search::show_uci_result(const ThreadData* td, U64 elapsed, PVariation& pv)
 
 #if defined USE_PRETTY
     std::cout << " depth "    << std::setw(2) << td->best_depth                     // depth <x> search depth in plies
-              << " seldepth " << std::setw(2) << td->seldepth                       // seldepth <x> selective search depth in plies
+              << " seldepth " << std::setw(2) << td->seldepth;                      // seldepth <x> selective search depth in plies
 #else
     std::cout << " depth "    << td->best_depth
-              << " seldepth " << td->seldepth
+              << " seldepth " << td->seldepth;
 #endif
 
+    // multipv <num> : numéro de la ligne, à partir de 1
+    if (td->multipv > 1)
+        std::cout << " multipv " << line;
+
+
 // time     : the time searched in ms
 // nodes    : noeuds calculés
 // nps      : nodes per second searched
 
 #if defined USE_PRETTY
-              << " time "       << std::setw(6) << elapsed                          // time <x> the time searched in ms
+    std::cout << " time "       << std::setw(6) << elapsed                          // time <x> the time searched in ms
               << " nodes "      << std::setw(l) << all_nodes
               << " nps "        << std::setw(7) << all_nodes * 1000 / elapsed       // nps <x> x nodes per second searched,
               << " tbhits "     << all_tbhits                                       // tbhits <x> x positions where found in the endgame table bases
               << " hashfull "   << std::setw(5) << hash_full;                       // hashfull <x> the hash is x permill full,
 #else
-              << " time "       << elapsed
+    std::cout << " time "       << elapsed
               << " nodes "      << all_nodes
               << " nps "        << all_nodes * 1000 / elapsed
               << " tbhits "     << all_tbhits
               << " hashfull "   << hash_full;
 #endif
 
-    if (td->best_score >= MATE_IN_X)
+    if (score >= MATE_IN_X)
     {
-        std::cout << " score mate " << (MATE - td->best_score) / 2 + 1;             // score mate <y> mate in y moves, not plies.
+        std::cout << " score mate " << (MATE - score) / 2 + 1;                      // score mate <y> mate in y moves, not plies.
     }
-    else if (td->best_score <= -MATE_IN_X)
+    else if (score <= -MATE_IN_X)
     {
-        std::cout << " score mate " << (-MATE - td->best_score) / 2;
+        std::cout << " score mate " << (-MATE - score) / 2;
     }
     else
     {
 
 #if defined USE_PRETTY
-        std::cout << " score cp " << std::right << std::setw(5) << td->best_score;  // score cp <x> the score from the engine's point of view in centipawns.
+        std::cout << " score cp " << std::right << std::setw(5) << score;  // score cp <x> the score from the engine's point of view in centipawns.
 #else
-        std::cout << " score cp " << td->best_score;
+        std::cout << " score cp " << score;
 #endif
     }
 
@@ -127,7 +133,14 @@ void Search::show_uci_result(const ThreadData* td, U64 elapsed, PVariation& pv)
 void Search::show_uci_best(const ThreadData* td) const
 {
     // ATTENTION AU FORMAT D'AFFICHAGE
-    std::cout << "bestmove " << Move::name(td->best_move) << std::endl;
+    // pas de coup légal (mat ou pat) : "0000"
+    if (td->best_move == Move::MOVE_NONE)
+        std::cout << "bestmove 0000";
+    else
+        std::cout << "bestmove " << Move::name(td->best_move);
+    if (td->ponder_move != Move::MOVE_NONE)
+        std::cout << " ponder " << Move::name(td->ponder_move);
+    std::cout << std::endl;
 }
 
 //=========================================================
@@ -159,16 +172,21 @@ void Search::update_pv(PVariation& pv, const PVariation& new_pv, const MOVE move
 //! \return Retourne "true" si la recherche a dépassé sa limite de temps
 //!
 //! De façon à éviter un nombre important de calculs , on ne fera
-//! ce calcul que tous les 4096 coups.
+//! ce calcul que tous les 1024 coups.
+//! Le temps n'est pas testé ici : c'est la thread "timekeeper"
+//! qui arrête la recherche (voir ThreadPool::start_timekeeper).
 //---------------------------------------------------------
 bool Search::check_limits(const ThreadData* td) const
 {
-    // Every 4096 nodes, check if our time has expired.
-    // On ne teste pas si nodes=0
+    if ((td->nodes & 1023) != 1023)
+        return false;
+
+    // Limite en noeuds : chaque thread compare le total
+    // des noeuds de toutes les threads au budget.
+    // Le dépassement est au plus de 1024 noeuds par thread.
+    U64 limit = threadPool.control.node_limit.load(std::memory_order_relaxed);
 
-    return((td->nodes & 4095) == 4095
-            && td->index == 0
-            && timer.finishOnThisMove());
+    return (limit != 0 && threadPool.get_all_nodes() >= limit);
 
     //    if (  (td->nodes & 4095) != 4095
     //        || td->index != 0)
@@ -3,43 +3,24 @@
 
 
 class Search;
+struct ThreadData;
 
 #include <thread>
+#include <atomic>
+#include <vector>
 #include "defines.h"
 #include "Timer.h"
 #include "OrderInfo.h"
 #include "Board.h"
+#include "PawnCache.h"
+#include "Material.h"
+#include "NNUE.h"
 #include "types.h"
 
 // STACK_OFFSET permet de faire "ply-x" en évitant un test
 constexpr int STACK_OFFSET = 4;
 constexpr int STACK_SIZE   = MAX_PLY + STACK_OFFSET;
 
-
-//! \brief  Données d'une thread
-struct ThreadData {
-    std::thread thread;
-    U64         nodes;
-    U64         tbhits;
-    int         index;
-    MOVE        best_move;
-    int         best_score;
-    int         best_depth;
-    int         score;
-    int         depth;
-    int         seldepth;
-    bool        stopped;
-    
-    OrderInfo   order;
-    Score       eval_stack[STACK_SIZE];     // évaluation statique
-    MOVE        move_stack[STACK_SIZE];     // coups cherchés
-    Score*      eval;
-    MOVE*       move;
-
-
-}__attribute__((aligned(64)));
-
-
 // classe permettant de redéfinir mon 'locale'
 // en effet, je n'en ai pas trouvé (windows ? mingw ?)
 // de qui permet d'écrire un entier avec un séparateur : 1.000.000
@@ -69,10 +50,11 @@ private:
     template <Color C> void iterative_deepening(ThreadData* td);
     template <Color C> int aspiration_window(int ply, PVariation& pv, ThreadData* td);
     template <Color C> int alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv, ThreadData* td);
-    template <Color C> int quiescence(int ply, int alpha, int beta, ThreadData* td);
+    template <Color C> int quiescence(int ply, int alpha, int beta, int depth, ThreadData* td);
 
-    void show_uci_result(const ThreadData *td, U64 elapsed, PVariation &pv) const;
+    void show_uci_result(const ThreadData *td, U64 elapsed, int score, const PVariation &pv, int line) const;
     void show_uci_best(const ThreadData *td) const;
+    template<Color C> MOVE ponder_from_tt(MOVE best);
     void show_uci_current(MOVE move, int currmove, int depth) const;
     bool check_limits(const ThreadData *td) const;
     void update_pv(PVariation &pv, const PVariation &new_pv, const MOVE move) const;
@@ -85,4 +67,52 @@ private:
 
 };
 
+//! \brief  Données d'une thread
+//----------------------------------------------------------
+//  Compteur de noeuds d'une thread
+//  Il occupe sa propre ligne de cache. Seule la thread propriétaire
+//  le modifie (sans instruction "lock") ; les autres threads peuvent
+//  le lire à tout moment (voir ThreadPool::get_all_nodes).
+
+struct alignas(64) NodeCounter {
+    std::atomic<U64> count{0};
+
+    void operator++(int) { count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+    void operator--(int) { count.store(count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed); }
+    NodeCounter& operator=(U64 value) { count.store(value, std::memory_order_relaxed); return *this; }
+    operator U64() const { return count.load(std::memory_order_relaxed); }
+};
+
+struct ThreadData {
+    std::thread thread;
+    bool        searching;      // la thread est en cours de recherche
+    Search      search;         // chaque thread possède sa recherche (et donc son Board)
+    PawnCache   pawn_cache;     // table des pions propre à la thread
+    MaterialCache material_cache; // table du matériel propre à la thread
+#if defined USE_NNUE
+    AccumulatorStack accumulators; // accumulateurs du réseau propres à la thread
+#endif
+    NodeCounter nodes;
+    U64         tbhits;
+    int         index;
+    MOVE        best_move;
+    MOVE        ponder_move;    // réponse attendue de l'adversaire
+    int         best_score;
+    int         best_depth;
+    int         score;
+    int         depth;
+    int         seldepth;
+    int         multipv;        // nombre de lignes cherchées (MultiPV)
+    int         pv_index;       // ligne en cours de recherche
+    std::vector<RootMove> root_moves;   // coups de la racine, triés à chaque itération
+    
+    OrderInfo   order;
+    Score       eval_stack[STACK_SIZE];     // évaluation statique
+    MOVE        move_stack[STACK_SIZE];     // coups cherchés
+    Score*      eval;
+    MOVE*       move;
+
+
+}__attribute__((aligned(64)));
+
 #endif // SEARCH_H
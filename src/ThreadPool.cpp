@@ -5,6 +5,7 @@
 #include "TranspositionTable.h"
 #include "Move.h"
 #include <cstring>
+#include <algorithm>
 
 
 //=================================================
@@ -13,7 +14,11 @@
 ThreadPool::ThreadPool(int _nbr, bool _tb, bool _log) :
     nbrThreads(_nbr),
     useSyzygy(_tb),
-    logUci(_log)
+    logUci(_log),
+    multiPV(1),
+    pawnSize(PAWN_HASH_SIZE),
+    exiting(false),
+    nbrWorkers(0)
 {
 #if defined DEBUG_LOG
     char message[200];
@@ -24,6 +29,16 @@ ThreadPool::ThreadPool(int _nbr, bool _tb, bool _log) :
     set_threads(_nbr);
 }
 
+//=================================================
+//! \brief  Destructeur
+//! Les threads doivent être terminées avant
+//! la destruction des std::thread
+//-------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    release_workers();
+}
+
 //=================================================
 //! \brief  Initialisation du nombre de threads
 //-------------------------------------------------
@@ -39,7 +54,92 @@ void ThreadPool::set_threads(int nbr)
     nbrThreads     = std::max(nbrThreads, 1);
     nbrThreads     = std::min(nbrThreads, MAX_THREADS);
 
+    // On ne re-crée les threads que si leur nombre change
+    if (nbrThreads == nbrWorkers)
+        return;
+
+    release_workers();
     create();
+    launch_workers();
+}
+
+//=================================================
+//! \brief  Lancement des threads de recherche.
+//! Chaque thread attend ensuite dans "idle_loop"
+//! qu'une recherche soit demandée.
+//-------------------------------------------------
+void ThreadPool::launch_workers()
+{
+    exiting = false;
+
+    for (int i = 0; i < nbrThreads; i++)
+    {
+        threadData[i].searching = true;     // mis à false par la thread elle-même
+        threadData[i].thread    = std::thread(&ThreadPool::idle_loop, this, i);
+    }
+    nbrWorkers = nbrThreads;
+
+    // attente que toutes les threads soient prêtes
+    wait(0);
+}
+
+//=================================================
+//! \brief  Arrêt définitif des threads de recherche
+//-------------------------------------------------
+void ThreadPool::release_workers()
+{
+    if (nbrWorkers == 0)
+        return;
+
+    stop();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    cv.notify_all();
+
+    for (int i = 0; i < nbrWorkers; i++)
+    {
+        if (threadData[i].thread.joinable())
+            threadData[i].thread.join();
+    }
+    nbrWorkers = 0;
+}
+
+//=================================================
+//! \brief  Boucle d'attente d'une thread
+//! La thread dort sur la variable de condition
+//! jusqu'à la commande "go", effectue sa recherche,
+//! puis se rendort. Elle n'est détruite qu'à la fin
+//! du programme, ou lors d'un changement du nombre de threads.
+//-------------------------------------------------
+void ThreadPool::idle_loop(int index)
+{
+    ThreadData* td = &threadData[index];
+
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        // signale que la recherche est finie
+        td->searching = false;
+        cv.notify_all();
+
+        cv.wait(lock, [&]{ return td->searching || exiting; });
+
+        if (exiting)
+            return;
+
+        lock.unlock();
+
+        if (job)
+            job(index, nbrWorkers);
+        else if (search_board.side_to_move == WHITE)
+            td->search.think<WHITE>(search_board, search_timer, index);
+        else
+            td->search.think<BLACK>(search_board, search_timer, index);
+    }
 }
 
 //=================================================
@@ -55,11 +155,18 @@ void ThreadPool::create()
         threadData[i].score      = -INFINITE;
         threadData[i].seldepth   = 0;
         threadData[i].nodes      = 0;
-        threadData[i].stopped    = false;
 
         threadData[i].move = &(threadData[i].move_stack[STACK_OFFSET]);
         threadData[i].eval = &(threadData[i].eval_stack[STACK_OFFSET]);
 
+        // ne fait rien si les tables sont déjà allouées (à la bonne taille)
+        threadData[i].pawn_cache.init_size(pawnSize);
+        threadData[i].material_cache.init();
+        threadData[i].order.init();
+#if defined USE_NNUE
+        threadData[i].accumulators.init();
+#endif
+
         // threadData[i].results.depth     = 0;
         // threadData[i].results.prevScore = -INFINITE;
     }
@@ -91,9 +198,8 @@ void ThreadPool::init()
         // memset(threadData[i].results.scores, 0,               sizeof(threadData[i].results.scores));
         // memset(threadData[i].results.moves,  Move::MOVE_NONE, sizeof(threadData[i].results.moves));
 
-        // Il faut avoir une copie du Board
-        // de façon à éviter les problèmes en multi-threads
-//        threadData[i].board = *board;
+        // La copie du Board est faite par chaque thread
+        // dans sa propre Search (Search::think)
     }
 }
 
@@ -111,14 +217,28 @@ void ThreadPool::reset()
         threadData[i].seldepth   = 0;
 
         threadData[i].order.clear_all();
+        threadData[i].pawn_cache.clear();
+        threadData[i].material_cache.clear();
     }
 }
 
+//=================================================
+//! \brief  Modification de la taille des tables de pions
+//! \param[in]  kb  taille de la table de chaque thread, en Ko
+//-------------------------------------------------
+void ThreadPool::set_pawn_size(int kb)
+{
+    pawnSize = kb;
+
+    for (int i = 0; i < nbrThreads; i++)
+        threadData[i].pawn_cache.init_size(pawnSize);
+}
+
 //=================================================
 //! \brief  Lance la recherche
 //! Fonction lancée par Uci::parse_go
 //-------------------------------------------------
-void ThreadPool::start_thinking(const Board& board, const Timer& timer)
+void ThreadPool::start_thinking(const Board& board, const Timer& timer, bool ponder)
 {
 #if defined DEBUG_LOG
     char message[100];
@@ -128,14 +248,17 @@ void ThreadPool::start_thinking(const Board& board, const Timer& timer)
 
     MOVE best = 0;
 
+    // En analyse (MultiPV, searchmoves), on cherche toujours
+    bool analysis = (multiPV > 1 || !timer.limits.searchmoves.empty());
+
     // Probe Opening Book
-    if(ownBook.get_useBook() == true && (best = ownBook.get_move(board)) != 0)
+    if(!analysis && ownBook.get_useBook() == true && (best = ownBook.get_move(board)) != 0)
     {
         std::cout << "bestmove " << Move::name(best) << std::endl;
     }
 
     // Probe Syzygy TableBases
-    else if (useSyzygy && board.probe_root(best) == true)
+    else if (!analysis && useSyzygy && board.probe_root(best) == true)
     {
         std::cout << "bestmove " << Move::name(best) << std::endl;
     }
@@ -149,35 +272,124 @@ void ThreadPool::start_thinking(const Board& board, const Timer& timer)
         create();
         init();
 
-        for (int i=0; i<nbrThreads; i++)
-            threadData[i].stopped = false;
+        // Contrôle de la recherche
+        control.stop.store(false, std::memory_order_relaxed);
+        control.pondering.store(ponder, std::memory_order_relaxed);
+        control.ponderhit.store(false, std::memory_order_relaxed);
+        control.node_limit.store(timer.limits.nodes, std::memory_order_relaxed);
 
         // Préparation des tables de transposition
         transpositionTable.update_age();
 
-        // On utilise la même instance de Search pour toutes les threads,
-        // à condition que les threads n'utilisent pas les mêmes valeurs.
-        Search uci_search;
+        // copie des arguments
+        search_board = board;
+        search_timer = timer;
+        init_root_moves();
 
-        // Il faut mettre le lancement des threads dans une boucle séparée
-        // car il faut être sur que la Search soit bien créée
+        // Surveillance du temps
+        // En mode "ponder", elle ne commence qu'au "ponderhit"
+        if (!ponder)
+            start_timekeeper(search_timer);
 
-        int side = board.side_to_move;
-
-        for (int i = 0; i < nbrThreads; i++)
+        // On réveille les threads, qui attendent dans "idle_loop".
+        // Chaque thread possède sa propre Search, donc sa propre copie
+        // du Board : il n'y a aucun partage en dehors de la table de transposition.
         {
-            // copie des arguments
-            Board b = board;
-            Timer t = timer;
-
-            if (side == WHITE)
-                threadData[i].thread = std::thread(&Search::think<WHITE>, &uci_search, b, t, i);
-            else
-                threadData[i].thread = std::thread(&Search::think<BLACK>, &uci_search, b, t, i);
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int i = 0; i < nbrThreads; i++)
+                threadData[i].searching = true;
         }
+        cv.notify_all();
+    }
+}
+
+//=================================================
+//! \brief  Préparation des coups de la racine
+//! La liste est construite une seule fois, puis copiée
+//! par chaque thread (voir Search::think) :
+//!     - coups légaux, limités par "go searchmoves"
+//!     - classement par les tables Syzygy, le meilleur en tête
+//-------------------------------------------------
+void ThreadPool::init_root_moves()
+{
+    MoveList ml;
+    if (search_board.side_to_move == WHITE)
+        search_board.legal_moves<WHITE>(ml);
+    else
+        search_board.legal_moves<BLACK>(ml);
+
+    const auto& searchmoves = search_timer.limits.searchmoves;
+
+    root_moves.clear();
+    for (size_t i = 0; i < ml.count; i++)
+    {
+        MOVE move = ml.moves[i];
+
+        if (   !searchmoves.empty()
+            && std::find(searchmoves.begin(), searchmoves.end(), Move::name(move)) == searchmoves.end())
+            continue;
+
+        RootMove rm;
+        rm.move       = move;
+        rm.score      = -INFINITE;
+        rm.prev_score = -INFINITE;
+        rm.nodes      = 0;
+        rm.tb_rank    = 0;
+        rm.pv.line[0] = move;
+        rm.pv.length  = 1;
+        root_moves.push_back(rm);
+    }
+
+    // aucun des coups demandés n'est légal : on les cherche tous
+    if (root_moves.empty() && !searchmoves.empty())
+    {
+        search_timer.limits.searchmoves.clear();
+        init_root_moves();
+        return;
+    }
+
+    if (useSyzygy && search_board.probe_root_ranks(root_moves))
+    {
+        std::stable_sort(root_moves.begin(), root_moves.end(),
+                         [](const RootMove& a, const RootMove& b) { return a.tb_rank > b.tb_rank; });
     }
 }
 
+//=================================================
+//! \brief  L'adversaire a joué le coup attendu
+//! La recherche continue, mais devient une recherche
+//! à la pendule ; celle-ci démarre maintenant.
+//! Les threads copient peut-être encore "search_timer" :
+//! on redémarre donc une autre pendule.
+//-------------------------------------------------
+void ThreadPool::ponderhit()
+{
+    if (!is_pondering())
+        return;
+
+    ponder_timer = search_timer;
+    ponder_timer.start();
+    start_timekeeper(ponder_timer);
+
+    // la thread 0 récupère la pendule (voir Search::iterative_deepening)
+    control.ponderhit.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        control.pondering.store(false, std::memory_order_release);
+    }
+    cv.notify_all();
+}
+
+//=================================================
+//! \brief  Attente de "ponderhit" ou "stop"
+//! La thread 0 ne doit pas donner son coup avant.
+//-------------------------------------------------
+void ThreadPool::wait_ponder_end()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]{ return !is_pondering(); });
+}
+
 //=================================================
 //! \brief  Arrêt de la recherche
 //! L'arrêt a été commandé par la thread 0
@@ -187,25 +399,30 @@ void ThreadPool::main_thread_stopped()
 {
     // envoie à toutes les autres threads
     // le signal d'arrêter
+    signal_stop();
 
-    for (int i = 1; i < nbrThreads; i++)
-        threadData[i].stopped = true;
+    // la surveillance du temps est inutile
+    stop_timekeeper();
 
     // NE PAS détruire les search, on en a besoin
     // pour calculer le nombre de nodes
 }
 
 //=================================================
-//! \brief  On impose l'arrêt de la recherche
-//! que ce soit une commande uci-stop, ou autre.
+//! \brief  Attente de la fin de la recherche
+//! des threads [start, nbrThreads[
+//! Les threads ne sont pas détruites.
 //-------------------------------------------------
 void ThreadPool::wait(int start)
 {
-    for (int i = start; i < nbrThreads; i++)
-    {
-        if (threadData[i].thread.joinable())
-            threadData[i].thread.join();
-    }
+    std::unique_lock<std::mutex> lock(mutex);
+
+    cv.wait(lock, [&]{
+        for (int i = start; i < nbrWorkers; i++)
+            if (threadData[i].searching)
+                return false;
+        return true;
+    });
 }
 
 //=================================================
@@ -214,10 +431,82 @@ void ThreadPool::wait(int start)
 //-------------------------------------------------
 void ThreadPool::stop()
 {
-    threadData[0].stopped = true;
+    signal_stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        control.pondering.store(false, std::memory_order_release);
+    }
+    cv.notify_all();
+
+    // attente de la fin de toutes les threads
+    wait(0);
+    stop_timekeeper();
+}
+
+//=================================================
+//! \brief  Lancement de la surveillance du temps
+//! La thread "timekeeper" dort jusqu'à l'heure limite
+//! de la recherche, puis lève le signal d'arrêt : les threads
+//! de recherche n'ont donc jamais à lire l'horloge.
+//-------------------------------------------------
+void ThreadPool::start_timekeeper(const Timer& timer)
+{
+    stop_timekeeper();
+
+    tk_active = true;
+    timekeeper = std::thread([this, deadline = timer.deadline()] {
+        std::unique_lock<std::mutex> lock(tk_mutex);
+        if (!tk_cv.wait_until(lock, deadline, [this]{ return !tk_active; }))
+            signal_stop();
+    });
+}
+
+//=================================================
+//! \brief  Arrêt de la surveillance du temps
+//-------------------------------------------------
+void ThreadPool::stop_timekeeper()
+{
+    {
+        std::lock_guard<std::mutex> lock(tk_mutex);
+        tk_active = false;
+    }
+    tk_cv.notify_all();
+
+    if (timekeeper.joinable())
+        timekeeper.join();
+}
+
+//=================================================
+//! \brief  Exécution d'une tâche par toutes les threads
+//! La fonction reçoit l'index de la thread et le
+//! nombre de threads. On attend la fin de la tâche.
+//-------------------------------------------------
+void ThreadPool::run_job(const std::function<void(int, int)>& func)
+{
+    // attente de la fin d'une éventuelle recherche
+    wait(0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = func;
+        for (int i = 0; i < nbrWorkers; i++)
+            threadData[i].searching = true;
+    }
+    cv.notify_all();
 
-    if (threadData[0].thread.joinable())
-        threadData[0].thread.join();
+    wait(0);
+    job = nullptr;
+}
+
+//=================================================
+//! \brief  Remise à zéro de la table de transposition
+//! Chaque thread efface sa partie de la table
+//-------------------------------------------------
+void ThreadPool::clear_hash()
+{
+    run_job([](int index, int count) {
+        transpositionTable.clear_part(index, count);
+    });
 }
 
 //=================================================
@@ -225,8 +514,7 @@ void ThreadPool::stop()
 //-------------------------------------------------
 void ThreadPool::quit()
 {
-    stop();
-
+    release_workers();
 }
 
 //=================================================
@@ -3,44 +3,125 @@
 
 class ThreadPool;
 
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <vector>
 #include "defines.h"
 #include "Board.h"
 #include "Timer.h"
 #include "Search.h"
 
+//----------------------------------------------------------
+//  Contrôle de la recherche, partagé par toutes les threads
+//  Il occupe sa propre ligne de cache : les threads le lisent
+//  sans cesse (lectures "relaxed"), sans faux partage avec
+//  les autres données.
+
+struct alignas(64) SearchControl {
+    std::atomic<bool> stop{false};          // arrêt de la recherche
+    std::atomic<bool> pondering{false};     // réflexion sur le temps de l'adversaire
+    std::atomic<bool> ponderhit{false};     // "ponderhit" reçu pendant la réflexion
+    std::atomic<U64>  node_limit{0};        // budget de noeuds (0 : pas de limite)
+};
+
 class ThreadPool
 {
 public:
     explicit ThreadPool(int _nbr, bool _tb, bool _log);
+    ~ThreadPool();
     void set_threads(int nbr);
     void create();
     void init();
     void reset();
 
-    void start_thinking(const Board &board, const Timer &timer);
+    void start_thinking(const Board &board, const Timer &timer, bool ponder = false);
+    void ponderhit();
+    void wait_ponder_end();
     void main_thread_stopped();
     void stop();
     void wait(int start);
     void quit();
 
+    //! \brief  La recherche doit-elle s'arrêter ?
+    bool is_stopped() const { return control.stop.load(std::memory_order_relaxed); }
+
+    //! \brief  Demande l'arrêt de toutes les threads
+    void signal_stop() { control.stop.store(true, std::memory_order_relaxed); }
+
+    //! \brief  Réfléchit-on sur le temps de l'adversaire ?
+    bool is_pondering() const { return control.pondering.load(std::memory_order_acquire); }
+
+    //! \brief  Pendule redémarrée lors de "ponderhit"
+    //! Elle ne doit être lue qu'après avoir obtenu
+    //! le signal "ponderhit" (voir Search::iterative_deepening)
+    const Timer& get_ponder_timer() const { return ponder_timer; }
+
+    //! \brief  Coups de la racine de la recherche en cours
+    const std::vector<RootMove>& get_root_moves() const { return root_moves; }
+
+    void start_timekeeper(const Timer& timer);
+    void stop_timekeeper();
+
+    void run_job(const std::function<void(int, int)>& func);
+    void clear_hash();
+
     U64  get_all_nodes() const;
     int  get_all_depths() const;
     MOVE get_best_move() const { return threadData[0].best_move; }
     U64  get_all_tbhits() const;
 
+    void set_pawn_size(int kb);
     void set_logUci(bool f)     { logUci = f;       }
     void set_useSyzygy(bool f)  { useSyzygy = f;    }
+    void set_multiPV(int n)     { multiPV = n;      }
 
     bool get_logUci() const { return logUci; }
     int  get_nbrThreads() const { return nbrThreads; }
     bool get_useSyzygy() const { return useSyzygy; }
+    int  get_multiPV() const { return multiPV; }
 
     std::array<ThreadData, MAX_THREADS> threadData;
+    SearchControl control;
 
 private:
     int     nbrThreads;
     bool    useSyzygy;
     bool    logUci;
+    int     multiPV;        // nombre de variations à chercher
+    int     pawnSize;       // taille de la table des pions de chaque thread, en Ko
+
+    // Les threads sont créées une seule fois, et attendent
+    // la commande "go" sur la variable de condition.
+    std::mutex              mutex;
+    std::condition_variable cv;
+    bool                    exiting;
+    int                     nbrWorkers;     // nombre de threads réellement lancées
+
+    // Tâche à exécuter par les threads, à la place d'une recherche
+    // (voir run_job) ; arguments : index de la thread, nombre de threads
+    std::function<void(int, int)> job;
+
+    // Thread surveillant le temps de la recherche :
+    // elle dort jusqu'à l'heure limite, puis arrête la recherche
+    std::thread             timekeeper;
+    std::mutex              tk_mutex;
+    std::condition_variable tk_cv;
+    bool                    tk_active = false;
+
+    // Données de la recherche en cours
+    // Chaque thread en fait une copie dans sa propre Search
+    Board   search_board;
+    Timer   search_timer;
+    Timer   ponder_timer;                // pendule redémarrée lors de "ponderhit"
+    std::vector<RootMove> root_moves;   // coups de la racine (voir init_root_moves)
+
+    void init_root_moves();
+
+    void idle_loop(int index);
+    void launch_workers();
+    void release_workers();
 
 };
 
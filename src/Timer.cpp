@@ -22,7 +22,7 @@ Timer::Timer(bool infinite,
              int binc,
              int movestogo,
              int depth,
-             int nodes,
+             U64 nodes,
              int movetime)
 {
     limits.time[WHITE] = wtime;
@@ -38,6 +38,7 @@ Timer::Timer(bool infinite,
     timeForThisDepth    = 0;
     timeForThisMove     = 0;
     searchDepth         = 0;
+    adaptive            = false;
 }
 
 void Timer::reset()
@@ -55,6 +56,7 @@ void Timer::reset()
     timeForThisDepth    = 0;
     timeForThisMove     = 0;
     searchDepth         = 0;
+    adaptive            = false;
 }
 
 //===========================================================
@@ -82,6 +84,7 @@ void Timer::setup(Color color)
     searchDepth         = MAX_PLY;
     timeForThisMove     = MAX_TIME;
     timeForThisDepth    = MAX_TIME;
+    adaptive            = false;
 
     if (limits.infinite) // recherche infinie (temps et profondeur)
     {
@@ -134,6 +137,7 @@ void Timer::setup(Color color)
         }
 
         timeForThisMove = std::min(5.0 * timeForThisDepth, 0.8 * time);
+        adaptive        = true;
     }
 
 
@@ -164,12 +168,31 @@ int Timer::elapsedTime()
 //===========================================================
 //! \brief  Détermine si on a assez de temps pour effectuer
 //!         une nouvelle itération
-//! \param  elapsedTime     temps en millisecondes
 //!
+//! En partie à la pendule, le temps prévu est modulé par :
+//!     + la stabilité du meilleur coup
+//!     + la chute du score depuis l'itération précédente
+//!     + la part des noeuds consacrée au meilleur coup
+//! Le temps maximum (timeForThisMove) reste la limite absolue.
+//!
+//! \param  elapsed     temps en millisecondes
+//! \param  stability   nombre d'itérations sans changement du meilleur coup
+//! \param  score_drop  baisse du score depuis l'itération précédente
+//! \param  best_nodes  part des noeuds consacrée au meilleur coup [0, 1]
 //-----------------------------------------------------------
-bool Timer::finishOnThisDepth(U64 elapsed, bool uncertain)
+bool Timer::finishOnThisDepth(U64 elapsed, int stability, int score_drop, double best_nodes)
 {
-    return (elapsed > timeForThisDepth * (1 + uncertain));
+    if (!adaptive)
+        return (elapsed > static_cast<U64>(timeForThisDepth));
+
+    // idées de Ethereal
+    constexpr double StabilityFactor[5] = { 2.00, 1.20, 0.90, 0.80, 0.75 };
+
+    double stability_factor = StabilityFactor[std::min(stability, 4)];
+    double score_factor     = std::clamp(1.0 + score_drop / 100.0, 0.90, 1.50);
+    double node_factor      = std::max(0.50, 2.0 * (1.0 - best_nodes) + 0.40);
+
+    return (elapsed > timeForThisDepth * stability_factor * score_factor * node_factor);
 }
 
 //==================================================================
@@ -5,6 +5,8 @@ class Timer;
 
 #include <cstdint>
 #include <chrono>
+#include <string>
+#include <vector>
 #include "defines.h"
 #include "types.h"
 
@@ -14,7 +16,7 @@ class Timer
 public:
     Timer();
     Timer(bool infinite, int wtime, int btime, int winc, int binc, int movestogo,
-          int depth, int nodes, int movetime);
+          int depth, U64 nodes, int movetime);
 
     struct Limits {
 
@@ -25,6 +27,7 @@ public:
         U64  nodes;       // limit search by nodes searched
         int  movetime;    // limit search by time
         bool infinite;    // ignore limits (infinite search)
+        std::vector<std::string> searchmoves;   // restrict search to these moves (uci notation)
 
         Limits() : time{}, incr{}, movestogo(0), depth(0), nodes(0), movetime(0), infinite(false) {};
     };
@@ -37,8 +40,14 @@ public:
     void start();
     void setup(Color color);
     bool finishOnThisMove() const;
-    bool finishOnThisDepth(U64 elapsed, bool uncertain);
+    bool finishOnThisDepth(U64 elapsed, int stability, int score_drop, double best_nodes);
     int  getSearchDepth() const { return(searchDepth); }
+
+    //! \brief  Instant où la recherche doit s'arrêter (voir ThreadPool::start_timekeeper)
+    std::chrono::time_point<std::chrono::high_resolution_clock> deadline() const
+    {
+        return startTime + std::chrono::milliseconds(timeForThisMove);
+    }
     int  elapsedTime();
 
 
@@ -50,6 +59,7 @@ private:
     int  timeForThisDepth;      // temps pour "iterative deepening"
     int  timeForThisMove;       // temps pour une recherche "alpha-beta" ou "quiescence"
     int  searchDepth;
+    bool adaptive;              // le temps alloué dépend du déroulement de la recherche
 
 
 };
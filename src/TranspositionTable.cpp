@@ -3,8 +3,15 @@
 #include "defines.h"
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
 #include "Move.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>       // madvise
+#elif defined(_WIN32)
+#include <malloc.h>         // _aligned_malloc
+#endif
+
 
 // Code inspiré de Sungorus
 // Idées provenant de Bruce Moreland
@@ -18,9 +25,7 @@
 //========================================================
 //! \brief  Constructeur avec argument
 //--------------------------------------------------------
-TranspositionTable::TranspositionTable(int MB) :
-    pawn_size(PAWN_HASH_SIZE*1024),
-    pawn_mask(PAWN_HASH_SIZE*1024 - 1)
+TranspositionTable::TranspositionTable(int MB)
 {
 #if defined DEBUG_LOG
     char message[100];
@@ -30,9 +35,11 @@ TranspositionTable::TranspositionTable(int MB) :
 
     tt_entries = nullptr;
     tt_size    = 0;
+    tt_bytes   = 0;
     tt_date    = 0;
 
     init_size(MB);
+    clear();
 }
 
 //========================================================
@@ -40,7 +47,46 @@ TranspositionTable::TranspositionTable(int MB) :
 //--------------------------------------------------------
 TranspositionTable::~TranspositionTable()
 {
-    delete [] tt_entries;
+    free_large(tt_entries);
+}
+
+//========================================================
+//! \brief  Allocation d'une grande zone mémoire
+//!
+//! Sous Linux, la zone est alignée sur 2 Mo et on demande
+//! au noyau de la placer dans des "huge pages" (THP) :
+//! cela réduit fortement les défauts de TLB sur une table
+//! de plusieurs Go.
+//! \return nullptr si l'allocation a échoué
+//--------------------------------------------------------
+void* TranspositionTable::alloc_large(U64 bytes)
+{
+#if defined(__linux__)
+    constexpr U64 alignment = 2 * 1024 * 1024;
+    U64   size = ((bytes + alignment - 1) / alignment) * alignment;
+    void* mem  = std::aligned_alloc(alignment, size);
+#if defined(MADV_HUGEPAGE)
+    if (mem != nullptr)
+        madvise(mem, size, MADV_HUGEPAGE);
+#endif
+    return mem;
+#elif defined(_WIN32)
+    return _aligned_malloc(bytes, 64);
+#else
+    return std::aligned_alloc(64, ((bytes + 63) / 64) * 64);
+#endif
+}
+
+//========================================================
+//! \brief  Libération d'une zone allouée par alloc_large
+//--------------------------------------------------------
+void TranspositionTable::free_large(void* mem)
+{
+#if defined(_WIN32)
+    _aligned_free(mem);
+#else
+    std::free(mem);
+#endif
 }
 
 //========================================================
@@ -54,14 +100,15 @@ void TranspositionTable::init_size(int mbsize)
     printlog(message);
 #endif
 
-    int bytes    = mbsize * 1024 * 1024;
-    int nbr_elem = bytes / sizeof(HashEntry);
+    U64 bytes    = static_cast<U64>(mbsize) * 1024 * 1024;
+    U64 nbr_elem = bytes / sizeof(HashCluster);
 
     if (tt_entries != nullptr)
     {
-        delete [] tt_entries;
+        free_large(tt_entries);
         tt_entries = nullptr;
-        tt_size = 0;
+        tt_size  = 0;
+        tt_bytes = 0;
     }
 
     // size must be a power of 2!
@@ -71,33 +118,43 @@ void TranspositionTable::init_size(int mbsize)
         tt_size *= 2;
     tt_size /= 2;
 
-    assert(tt_size!=0 && (tt_size&(tt_size-1))==0); // power of 2
-
     // Blunder 8 : 2 buckets , age = 0 ou 1
     // Leorik    : 2 buckets
     // berserk   : 2 buckets
 
-#if defined TT_SUNGORUS
-    tt_buckets = 4;
-#elif defined TT_LEORIK
-    tt_buckets = 2;
-#endif
+    // Si la mémoire demandée n'est pas disponible,
+    // on divise la taille par 2 jusqu'à y arriver
+    while (tt_entries == nullptr && tt_size > 1)
+    {
+        tt_bytes   = tt_size * sizeof(HashCluster);
+        tt_entries = static_cast<HashCluster*>(alloc_large(tt_bytes));
+        if (tt_entries == nullptr)
+            tt_size /= 2;
+    }
+    if (tt_entries == nullptr)
+    {
+        std::cout << "info string impossible d'allouer la table de transposition" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    if (tt_bytes < bytes / 2)
+        std::cout << "info string table de transposition réduite à " << tt_bytes / 1024 / 1024 << " Mo" << std::endl;
 
-    tt_mask    = tt_size - tt_buckets;
-    tt_entries = new HashEntry[tt_size];
+    assert(tt_size!=0 && (tt_size&(tt_size-1))==0); // power of 2
 
-    clear();
+    tt_mask    = tt_size - 1;
 
 
 #if defined DEBUG_LOG
-    sprintf(message, "TranspositionTable init complete with %d entries of %lu bytes for a total of %lu bytes (%lu MB) \n",
-            tt_size, sizeof(HashEntry), tt_size*sizeof(HashEntry), tt_size*sizeof(HashEntry)/1024/1024);
+    sprintf(message, "TranspositionTable init complete with %lu clusters of %lu bytes for a total of %lu bytes (%lu MB) \n",
+            tt_size, sizeof(HashCluster), tt_bytes, tt_bytes/1024/1024);
     printlog(message);
 #endif
 }
 
 //========================================================
 //! \brief  Allocation uniquement de la Hash Table
+//! La table n'est pas remise à zéro : c'est fait ensuite
+//! par ThreadPool::clear_hash, en parallèle
 //--------------------------------------------------------
 void TranspositionTable::set_hash_size(int mbsize)
 {
@@ -107,9 +164,10 @@ void TranspositionTable::set_hash_size(int mbsize)
     printlog(message);
 #endif
 
-    delete [] tt_entries;
+    free_large(tt_entries);
     tt_entries = nullptr;
-    tt_size = 0;
+    tt_size  = 0;
+    tt_bytes = 0;
     init_size(mbsize);
 }
 
@@ -124,10 +182,29 @@ void TranspositionTable::clear(void)
     printlog(message);
 #endif
 
-    tt_date = 0;
+    clear_part(0, 1);
+}
+
+//========================================================
+//! \brief  Remise à zéro d'une partie de la table
+//!
+//! La table est découpée en "count" tranches ; chaque thread
+//! efface la sienne, et c'est donc elle qui touche la première
+//! ses pages (first-touch) : sur une machine NUMA, celles-ci
+//! sont réparties sur les différents noeuds.
+//! \param[in]  index   numéro de la tranche [0, count[
+//! \param[in]  count   nombre de tranches
+//--------------------------------------------------------
+void TranspositionTable::clear_part(int index, int count)
+{
+    U64 stride = tt_size / count;
+    U64 start  = stride * index;
+    U64 length = (index == count - 1) ? tt_size - start : stride;
+
+    std::memset(static_cast<void*>(tt_entries + start), 0, length * sizeof(HashCluster));
 
-    std::memset(tt_entries, 0, sizeof(HashEntry) * tt_size);
-    std::memset(pawn_entries, 0, sizeof(PawnHashEntry) * pawn_size);
+    if (index == 0)
+        tt_date = 0;
 }
 
 //========================================================
@@ -166,24 +243,28 @@ void TranspositionTable::store(U64 hash, MOVE move, Score score, Score eval, int
 
     HashEntry *entry=nullptr, *replace=nullptr;
     int oldest, age;
+    U64 data, key_move;
 
     score = ScoreToTT(score, ply);
 
     replace = nullptr;
     oldest  = -1;
-    entry   = tt_entries + (hash & tt_mask);
+    entry   = tt_entries[hash & tt_mask].entry;
 
-    for (int i = 0; i < tt_buckets; i++)
+    for (int i = 0; i < TT_BUCKETS; i++)
     {
-        if (entry->hash == key32)
+        data     = entry->data.load(std::memory_order_relaxed);
+        key_move = entry->key_move.load(std::memory_order_relaxed) ^ check_word(data);
+
+        if ((key_move >> 32) == key32)
         {
             if (!move)
-                move = entry->move;
+                move = static_cast<MOVE>(key_move);
             replace = entry;
             break;
         }
 
-        age = ((tt_date - entry->date) & 255) * 256 + 255 - entry->depth;
+        age = ((tt_date - data_date(data)) & 255) * 256 + 255 - data_depth(data);
         if (age > oldest)
         {
             oldest  = age;
@@ -192,13 +273,11 @@ void TranspositionTable::store(U64 hash, MOVE move, Score score, Score eval, int
         entry++;
     }
 
-    replace->hash  = key32;
-    replace->move  = move;
-    replace->score = score;
-    replace->eval  = eval;
-    replace->depth = depth;
-    replace->date  = tt_date;
-    replace->flag  = flag;
+    data     = pack_data(score, eval, depth, tt_date, flag);
+    key_move = (static_cast<U64>(key32) << 32) | move;
+
+    replace->key_move.store(key_move ^ check_word(data), std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
 
 
 #endif
@@ -226,19 +305,29 @@ bool TranspositionTable::probe(U64 hash, int ply, MOVE& move, Score& score, Scor
 
 #if defined TT_SUNGORUS
 
-    HashEntry* entry = tt_entries + (hash & tt_mask);
+    HashEntry* entry = tt_entries[hash & tt_mask].entry;
 
-    for (int i = 0; i < tt_buckets; i++)
+    for (int i = 0; i < TT_BUCKETS; i++)
     {
-        if (entry->hash == key32)
-        {
-            entry->date = tt_date;
+        U64 data     = entry->data.load(std::memory_order_relaxed);
+        U64 key_move = entry->key_move.load(std::memory_order_relaxed) ^ check_word(data);
 
-            move  = entry->move;
-            flag  = entry->flag;
-            depth = entry->depth;
-            score = ScoreFromTT(entry->score, ply);
-            eval  = entry->eval;
+        if ((key_move >> 32) == key32)
+        {
+            // Mise à jour de l'age ; on ré-écrit les 2 mots
+            // de façon à conserver la cohérence de l'entrée
+            if (data_date(data) != tt_date)
+            {
+                data = (data & ~(0xFFULL << 40)) | (static_cast<U64>(tt_date) << 40);
+                entry->key_move.store(key_move ^ check_word(data), std::memory_order_relaxed);
+                entry->data.store(data, std::memory_order_relaxed);
+            }
+
+            move  = static_cast<MOVE>(key_move);
+            flag  = data_flag(data);
+            depth = data_depth(data);
+            score = ScoreFromTT(data_score(data), ply);
+            eval  = data_eval(data);
 
             return true;
         }
@@ -251,51 +340,15 @@ bool TranspositionTable::probe(U64 hash, int ply, MOVE& move, Score& score, Scor
     return false;
 }
 
-//===============================================================
-//! \brief  Recherche d'une donnée dans la table des pions
-//! \param[in]  hash    code hash des pions
-//! \param{out] score   score de cette position
-//! \param[out] passed  bitboard des pions passés
-//---------------------------------------------------------------
-bool TranspositionTable::probe_pawn_table(U64 hash, Score &eval, Bitboard& passed)
-{
-    PawnHashEntry* entry = pawn_entries + (hash & pawn_mask);
-
-    if (entry->hash == hash)
-    {
-        eval   = entry->eval;
-        passed = entry->passed;
-        return true;
-    }
-
-    return false;
-}
-
-//=============================================================
-//! \brief Stocke une évaluation dans la table des pions
-//!
-//! \param[in]  hash    hash des pions
-//! \param[in]  score   évaluation
-//! \param[in]  passed  bitboard des pions passés
-//-------------------------------------------------------------
-void TranspositionTable::store_pawn_table(U64 hash, Score eval, Bitboard passed)
-{
-    PawnHashEntry* entry = pawn_entries + (hash & pawn_mask);
-
-    entry->hash   = hash;
-    entry->eval   = eval;
-    entry->passed = passed;
-}
-
 
 void TranspositionTable::stats()
 {
     std::cout << "TT size = " << tt_size << std::endl;
-//    for (int i=0; i<tt_buckets; i++)
+//    for (int i=0; i<TT_BUCKETS; i++)
 //    {
 //        std::cout << "store[" << i+1 << "] = " << nbr_store[i] << std::endl;
 //    }
-//    for (int i=0; i<tt_buckets; i++)
+//    for (int i=0; i<TT_BUCKETS; i++)
 //    {
 //        std::cout << "probe[" << i+1 << "] = " << nbr_probe[i] << std::endl;
 //    }
@@ -316,11 +369,19 @@ int TranspositionTable::hash_full()
 {
     int used = 0;
 
-    for (int i = 0; i < tt_buckets*1000; i++)
-        if (   tt_entries[i].move != Move::MOVE_NONE
-            && tt_entries[i].date == tt_date)
-            used++;
+    for (int i = 0; i < 1000; i++)
+    {
+        for (const HashEntry& entry : tt_entries[i].entry)
+        {
+            U64 data = entry.data.load(std::memory_order_relaxed);
+            U64 move = entry.key_move.load(std::memory_order_relaxed) ^ check_word(data);
+
+            if (   static_cast<MOVE>(move) != Move::MOVE_NONE
+                && data_date(data) == tt_date)
+                used++;
+        }
+    }
 
-    return used/tt_buckets;
+    return used/TT_BUCKETS;
 }
 
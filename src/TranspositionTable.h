@@ -11,27 +11,51 @@ static constexpr int BOUND_EXACT = 2;   //              PV-node   (Knuth's Type
 
 class TranspositionTable;
 
+#include <atomic>
+#if defined(_MSC_VER)
+#include <xmmintrin.h>     // _mm_prefetch
+#endif
 #include "defines.h"
 
+//----------------------------------------------------------
+//  Table lockless (méthode de Hyatt, voir Crafty)
+//
+//  Une entrée est formée de 2 mots de 64 bits :
+//      data     : score 16 | eval 16 | depth 8 | date 8 | flag 8
+//      (la profondeur est signée : -1 dans la Quiescence)
+//      key_move : (clef 32 | coup 32) ^ check_word(data)
+//
+//  Chaque mot est lu et écrit de façon atomique, mais les 2 mots
+//  peuvent provenir d'écritures différentes (2 threads écrivant
+//  en même temps dans la même entrée). Dans ce cas, la clef retrouvée
+//  par "key_move ^ check_word(data)" ne correspond plus, et l'entrée
+//  est ignorée : on ne peut donc pas lire un coup et un score incohérents.
+//  check_word fait dépendre les 32 bits de la clef de tous les bits
+//  de data : un simple "^ data" ne protégerait pas le score et l'eval,
+//  situés dans les 32 bits de poids faible.
+
 struct HashEntry {
-    U32   hash;     // 32 bits
-    MOVE  move;     // 32 bits  (packing = 24 bits)
-    I16   score;    // 16 bits
-    I16   eval;     // 16 bits
-    U08   depth;    //  8 bits
-    U08   date;     //  8 bits
-    U08   flag;     //  8 bits  (3 bits nécessaires seulement)
+    std::atomic<U64> key_move;  // 64 bits
+    std::atomic<U64> data;      // 64 bits
 };
 
 //----------------------------------------------------------
-// Code provenant de Ethereal
-
-struct PawnHashEntry {
-    U64      hash;      // 64 bits
-    Bitboard passed;    // 64 bits
-    Score    eval;      // 32 bits
+//  Les entrées sont regroupées par "cluster" de la taille
+//  d'une ligne de cache : une recherche dans les buckets
+//  ne provoque ainsi qu'un seul défaut de cache.
+
+#if defined TT_SUNGORUS
+constexpr int TT_BUCKETS = 4;
+#elif defined TT_LEORIK
+constexpr int TT_BUCKETS = 2;
+#endif
+
+struct alignas(64) HashCluster {
+    HashEntry entry[TT_BUCKETS];
 };
 
+static_assert(sizeof(HashCluster) == 64, "HashCluster doit occuper une ligne de cache");
+
 //----------------------------------------------------------
 
 /* Remarques
@@ -53,31 +77,40 @@ struct PawnHashEntry {
 class TranspositionTable
 {
 private:
-    int         tt_size;
-    int         tt_mask;
-    int         tt_date;
-    int         tt_buckets;
-    HashEntry*  tt_entries = nullptr;
-
-    // Table de transposition pour les pions
-    PawnHashEntry   pawn_entries[PAWN_HASH_SIZE*1024];
-    int             pawn_size;
-    int             pawn_mask;
+    U64          tt_size;     // nombre de clusters
+    U64          tt_mask;
+    U64          tt_bytes;    // taille allouée, en octets
+    int          tt_date;
+    HashCluster* tt_entries = nullptr;
 
 public:
     TranspositionTable(int MB);
     ~TranspositionTable();
 
+    static void* alloc_large(U64 bytes);
+    static void  free_large(void* mem);
+
     void init_size(int mbsize);
     void set_hash_size(int mbsize);
 
     void clear(void);
+    void clear_part(int index, int count);
     void update_age(void);
     void store(U64 hash, MOVE move, Score score, Score eval, int flag, int depth, int ply);
     bool probe(U64 hash, int ply, MOVE &code, Score &score, Score &eval, int &flag, int &depth);
     void stats();
     int  hash_full();
 
+    //! \brief Chargement anticipé dans le cache du cluster correspondant à "hash"
+    void prefetch(U64 hash) const
+    {
+#if defined(__GNUC__) || defined(__llvm__)
+        __builtin_prefetch(tt_entries + (hash & tt_mask));
+#elif defined(_MSC_VER)
+        _mm_prefetch(reinterpret_cast<const char*>(tt_entries + (hash & tt_mask)), _MM_HINT_T0);
+#endif
+    }
+
     //! \brief Store terminal scores as distance from the current position to mate/TB
     int ScoreToTT (const int score, const int ply)
     {
@@ -94,10 +127,25 @@ public:
                                         : score;
     }
 
-    //------------------------------------------------
+    //! \brief Assemblage des données d'une entrée
+    static U64 pack_data(int score, int eval, int depth, int date, int flag)
+    {
+        return   static_cast<U64>(static_cast<U16>(score))
+              | (static_cast<U64>(static_cast<U16>(eval)) << 16)
+              | (static_cast<U64>(static_cast<U08>(depth)) << 32)
+              | (static_cast<U64>(static_cast<U08>(date))  << 40)
+              | (static_cast<U64>(static_cast<U08>(flag))  << 48);
+    }
+
+    //! \brief Mot de contrôle : la multiplication propage
+    //! chaque bit de data vers les bits de poids fort
+    static U64 check_word(U64 data) { return data * 0x9E3779B97F4A7C15ULL; }
 
-    bool probe_pawn_table(U64 hash, Score &eval, Bitboard &passed);
-    void store_pawn_table(U64 hash, Score eval, Bitboard passed);
+    static int data_score(U64 data) { return static_cast<I16>(data & 0xFFFF);         }
+    static int data_eval(U64 data)  { return static_cast<I16>((data >> 16) & 0xFFFF); }
+    static int data_depth(U64 data) { return static_cast<I08>(data >> 32);            }
+    static int data_date(U64 data)  { return static_cast<U08>(data >> 40);            }
+    static int data_flag(U64 data)  { return static_cast<U08>(data >> 48);            }
 };
 
 extern TranspositionTable transpositionTable;
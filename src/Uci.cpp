@@ -12,6 +12,7 @@
 #include "ThreadPool.h"
 #include "pyrrhic/tbprobe.h"
 #include "Move.h"
+#include "NNUE.h"
 
 Board   uci_board;
 Timer   uci_timer;
@@ -19,9 +20,15 @@ Timer   uci_timer;
 extern void test_perft(const std::string& abc, int dmax);
 extern void test_divide(const std::string& abc, int dmax);
 extern void test_suite(const std::string& abc, int dmax);
+extern void test_legal(const std::string& abc, int dmax);
 extern void test_eval(const std::string& abc);
 extern void test_mirror();
 extern void test_see();
+extern void test_tt();
+#if defined USE_NNUE
+extern void test_nnue();
+#endif
+extern void test_microbench(const std::string& what);
 
 
 //======================================
@@ -52,9 +59,19 @@ void Uci::run()
     std::cout << "option name Hash type spin default " << HASH_SIZE <<" min " << MIN_HASH_SIZE << " max " << MAX_HASH_SIZE << std::endl;
     std::cout << "option name Clear Hash type button" << std::endl;
     std::cout << "option name Threads type spin default 1 min 1 max " << MAX_THREADS << std::endl;
+    std::cout << "option name PawnHash type spin default " << PAWN_HASH_SIZE << " min " << MIN_PAWN_HASH_SIZE << " max " << MAX_PAWN_HASH_SIZE << std::endl;
+    std::cout << "option name Ponder type check default false" << std::endl;
+    std::cout << "option name MultiPV type spin default 1 min 1 max " << MAX_MULTIPV << std::endl;
     std::cout << "option name OwnBook type check default false" << std::endl;
     std::cout << "option name BookPath type string default " << "./" << std::endl;
     std::cout << "option name SyzygyPath type string default " << "<empty>" << std::endl;
+#if defined USE_NNUE
+#if defined NNUE_EMBEDDED
+    std::cout << "option name EvalFile type string default " << "<embedded>" << std::endl;
+#else
+    std::cout << "option name EvalFile type string default " << "<empty>" << std::endl;
+#endif
+#endif
 
     std::cout << "uciok" << std::endl;
 
@@ -79,6 +96,13 @@ void Uci::run()
             stop();
         }
 
+        else if (token == "ponderhit")
+        {
+            // the user has played the expected move. This will be sent if the engine was told to ponder on the same move
+            // the user has played. The engine should continue searching but switch from pondering to normal search.
+            threadPool.ponderhit();
+        }
+
         else if (token == "quit")
         {
             // quit the program as soon as possible
@@ -123,7 +147,7 @@ void Uci::run()
             // the next search (started with "position" and "go") will be from
             // a different game.
             uci_board.set_fen(START_FEN, false);
-            transpositionTable.clear();
+            threadPool.clear_hash();
             threadPool.reset();
         }
 
@@ -144,11 +168,17 @@ void Uci::run()
             std::cout << "q(uit) "      << std::endl;
             std::cout << "v(ersion) "   << std::endl;
             std::cout << "s <ref/big>                   : test suite_perft "                    << std::endl;
+            std::cout << "legal <ref/big>               : test de la validation rapide des coups "  << std::endl;
             std::cout << "divide                        : test divide "                         << std::endl;
             std::cout << "p <r/k/s>                     : test perft <Ref/Kiwipete/Silver2> "   << std::endl;
             std::cout << "bench                         : test de recherche sur un ensemble de positions"       << std::endl;
+            std::cout << "bench <gen/noisy/make/eval/see/all> : micro-benchmarks (ns par opération)"            << std::endl;
             std::cout << "eval                          : test evaluation"                                      << std::endl;
             std::cout << "see                           : test see"                                             << std::endl;
+            std::cout << "tt                            : test de la table de transposition multi-threads"      << std::endl;
+#if defined USE_NNUE
+            std::cout << "nnue                          : test des accumulateurs du réseau (parties aléatoires)" << std::endl;
+#endif
             std::cout << "run <s/k/q/f/w/b>             : test de recherche <Silver2/Kiwipete/Quies/Fine70/WAC2/BUG/REF>"           << std::endl;
             std::cout << "mirror                        : test mirror"                                          << std::endl;
             std::cout << "fen [str]                     : positionne la chaine fen"                             << std::endl;
@@ -170,6 +200,14 @@ void Uci::run()
             test_suite(str, dmax);
         }
 
+        else if (token == "legal")
+        {
+            std::string str;
+            iss >> str;
+
+            test_legal(str, dmax);
+        }
+
         else if (token == "divide")
         {
             test_divide(fen, dmax);
@@ -198,6 +236,18 @@ void Uci::run()
             test_see();
         }
 
+        else if(token == "tt")
+        {
+            test_tt();
+        }
+
+#if defined USE_NNUE
+        else if(token == "nnue")
+        {
+            test_nnue();
+        }
+#endif
+
         else if (token == "run")
         {
             std::string str;
@@ -208,7 +258,13 @@ void Uci::run()
 
         else if (token == "bench")
         {
-            go_bench(dmax, tmax);
+            std::string str;
+            iss >> str;
+
+            if (str.empty())
+                go_bench(dmax, tmax);
+            else
+                test_microbench(str);
         }
 
         else if (token == "fen")
@@ -289,14 +345,17 @@ void Uci::quit()
 void Uci::parse_go(std::istringstream& iss)
 {
     bool infinite   = false;
+    bool ponder     = false;
     int wtime       = 0;
     int btime       = 0;
     int winc        = 0;
     int binc        = 0;
     int movestogo   = 0;
     int depth       = 0;
-    int nodes       = 0;
+    U64 nodes       = 0;
     int movetime    = 0;
+    bool in_searchmoves = false;
+    std::vector<std::string> searchmoves;
 
     // Stop any running search
     Uci::stop();
@@ -314,6 +373,12 @@ void Uci::parse_go(std::istringstream& iss)
             // search until the "stop" command. Do not exit the search without being told so in this mode!
             infinite = true;
         }
+        else if (token == "ponder")
+        {
+            // start searching in pondering mode. Do not exit the search in ponder mode,
+            // even if it's mate! The last move sent in the position string is the ponder move.
+            ponder = true;
+        }
         else if (token == "wtime")
         {
             // white has x msec left on the clock
@@ -356,12 +421,22 @@ void Uci::parse_go(std::istringstream& iss)
             iss >> searchTime;
             movetime = searchTime;
         }
+        else if (token == "searchmoves")
+        {
+            // restrict search to the moves that follow, e.g. "searchmoves e2e4 d2d4"
+            in_searchmoves = true;
+        }
+        else if (in_searchmoves)
+        {
+            searchmoves.push_back(token);
+        }
     }
 
     // Reset the time manager
     uci_timer.reset();
 
     uci_timer = Timer(infinite, wtime, btime, winc, binc, movestogo, depth, nodes, movetime);
+    uci_timer.limits.searchmoves = searchmoves;
     uci_timer.start();
     uci_timer.setup(uci_board.side_to_move);
 
@@ -377,7 +452,7 @@ void Uci::parse_go(std::istringstream& iss)
 #endif
 
     // start the search
-    threadPool.start_thinking(uci_board, uci_timer);
+    threadPool.start_thinking(uci_board, uci_timer, ponder);
 }
 
 //=========================================================
@@ -435,6 +510,7 @@ setoption name <id> [value <x>]
             printlog(message);
 #endif
             transpositionTable.set_hash_size(mb);
+            threadPool.clear_hash();
         }
 
         else if (option_name == "Clear")
@@ -446,7 +522,7 @@ setoption name <id> [value <x>]
                 sprintf(message, "Uci::parse_options : Hash Clear");
                 printlog(message);
 #endif
-                transpositionTable.clear();
+                threadPool.clear_hash();
             }
         }
 
@@ -459,6 +535,28 @@ setoption name <id> [value <x>]
             threadPool.set_threads(nbr);
         }
 
+        else if (option_name == "PawnHash")
+        {
+            iss >> value;      // "value"
+            int kb;
+            iss >> kb;
+            kb = std::min(kb, MAX_PAWN_HASH_SIZE);
+            kb = std::max(kb, MIN_PAWN_HASH_SIZE);
+
+            threadPool.set_pawn_size(kb);
+        }
+
+        else if (option_name == "MultiPV")
+        {
+            iss >> value;      // "value"
+            int nbr;
+            iss >> nbr;
+            nbr = std::min(nbr, MAX_MULTIPV);
+            nbr = std::max(nbr, 1);
+
+            threadPool.set_multiPV(nbr);
+        }
+
         else if (option_name == "OwnBook")
         {
             iss >> value;      // "value"
@@ -524,6 +622,29 @@ setoption name <id> [value <x>]
                 threadPool.set_useSyzygy(TB_LARGEST > 0);
             }
         }
+
+#if defined USE_NNUE
+        else if (option_name == "EvalFile")
+        {
+            iss >> value;      // "value"
+
+            std::string path;
+            iss >> path;
+
+            // "<empty>" : évaluation classique
+            if (path == "<empty>" || path.empty())
+                nnue.unload();
+            else if (path == "<embedded>")
+            {
+                if (!nnue.load_embedded())
+                    std::cout << "info string pas de réseau inclus dans l'exécutable" << std::endl;
+            }
+            else if (nnue.load(path))
+                std::cout << "info string réseau " << path << " chargé" << std::endl;
+            else
+                std::cout << "info string impossible de charger le réseau " << path << std::endl;
+        }
+#endif
     }
     else
     {
@@ -561,7 +682,7 @@ void Uci::go_run(const std::string& abc, const std::string& fen, int dmax, int t
         "2rqr3/pb5Q/4p1p1/1P1p2k1/3P4/2N5/PP6/1K2R3 w - - 0 28 ";
     //"2rBrb2/3k1p2/1Q4p1/4P3/3n1P1p/2P4P/P6P/1K1R4 w - - 0 39";
 
-    transpositionTable.clear();
+    threadPool.clear_hash();
     threadPool.reset();
 
     // utiliser setoption name Clear Hash
@@ -761,7 +882,7 @@ void Uci::go_bench(int dmax, int tmax)
 //-------------------------------------------------------------
 bool Uci::go_tactics(const std::string& line, int dmax, int tmax, U64& total_nodes, U64& total_time, int& total_depths, bool& found_am)
 {
-    transpositionTable.clear();
+    threadPool.clear_hash();
     threadPool.reset();
 
     uci_board.set_fen(line, true);
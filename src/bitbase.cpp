@@ -0,0 +1,160 @@
+#include <vector>
+#include "Material.h"
+#include "Square.h"
+#include "Attacks.h"
+#include "bitmask.h"
+
+//  Bitbase Roi + Pion contre Roi
+//  Code inspiré de Stockfish (bitbase.cpp)
+//
+//  Le pion est blanc, et toujours sur les colonnes A à D :
+//  l'appelant se ramène à ce cas par symétrie.
+//  Une position est indexée par :
+//      roi blanc (6 bits) | roi noir (6 bits) | trait (1 bit)
+//      | colonne du pion (2 bits) | RANK_7 - rangée du pion (3 bits)
+
+namespace Bitbase {
+
+constexpr int MAX_INDEX = 2*24*64*64;   // trait * cases du pion * roi blanc * roi noir
+
+// bit à 1 : la position est gagnante pour les blancs
+U32 KPKBitbase[MAX_INDEX / 32];
+
+enum Result : U08 {
+    INVALID = 0,
+    UNKNOWN = 1,
+    DRAW    = 2,
+    WIN     = 4
+};
+
+//==========================================================
+//! \brief  Calcul de l'index d'une position
+//----------------------------------------------------------
+constexpr int index(Color stm, int bksq, int wksq, int psq)
+{
+    return wksq | (bksq << 6) | (stm << 12) | (SQ::file(psq) << 13) | ((RANK_7 - SQ::rank(psq)) << 15);
+}
+
+struct KPKPosition
+{
+    Color  us;
+    int    ksq[N_COLORS];
+    int    psq;
+    Result result;
+
+    //==========================================================
+    //! \brief  Classification initiale d'une position
+    //----------------------------------------------------------
+    explicit KPKPosition(int idx)
+    {
+        ksq[WHITE] = idx & 0x3F;
+        ksq[BLACK] = (idx >> 6) & 0x3F;
+        us         = static_cast<Color>((idx >> 12) & 0x01);
+        psq        = SQ::square((idx >> 13) & 0x03, RANK_7 - ((idx >> 15) & 0x07));
+
+        // Position impossible : rois en contact, pièces superposées,
+        // ou roi noir en échec avec les blancs au trait
+        if (   distance_between(ksq[WHITE], ksq[BLACK]) <= 1
+            || ksq[WHITE] == psq
+            || ksq[BLACK] == psq
+            || (us == WHITE && (Attacks::pawn_attacks(WHITE, psq) & BB::sq2BB(ksq[BLACK]))))
+            result = INVALID;
+
+        // Gain si le pion peut être promu sans être pris
+        else if (   us == WHITE
+                 && SQ::rank(psq) == RANK_7
+                 && ksq[WHITE] != psq + NORTH
+                 && (   distance_between(ksq[BLACK], psq + NORTH) > 1
+                     || distance_between(ksq[WHITE], psq + NORTH) == 1))
+            result = WIN;
+
+        // Nulle si les noirs sont pat, ou peuvent prendre le pion
+        else if (   us == BLACK
+                 && (   !(Attacks::king_moves(ksq[BLACK]) & ~(Attacks::king_moves(ksq[WHITE]) | Attacks::pawn_attacks(WHITE, psq)))
+                     || (Attacks::king_moves(ksq[BLACK]) & ~Attacks::king_moves(ksq[WHITE]) & BB::sq2BB(psq))))
+            result = DRAW;
+
+        // Position à déterminer
+        else
+            result = UNKNOWN;
+    }
+
+    //==========================================================
+    //! \brief  Classification d'une position à partir
+    //! de celles que l'on atteint en un coup.
+    //! Les blancs cherchent un coup gagnant, les noirs
+    //! un coup qui annule.
+    //----------------------------------------------------------
+    Result classify(const std::vector<KPKPosition>& db)
+    {
+        const Result Good = (us == WHITE ? WIN  : DRAW);
+        const Result Bad  = (us == WHITE ? DRAW : WIN);
+
+        Result   r = INVALID;
+        Bitboard b = Attacks::king_moves(ksq[us]);
+
+        while (b)
+        {
+            int s = BB::pop_lsb(b);
+            r = static_cast<Result>(r | (us == WHITE ? db[index(BLACK, ksq[BLACK], s, psq)].result
+                                                     : db[index(WHITE, s, ksq[WHITE], psq)].result));
+        }
+
+        if (us == WHITE)
+        {
+            // poussée simple
+            if (SQ::rank(psq) < RANK_7)
+                r = static_cast<Result>(r | db[index(BLACK, ksq[BLACK], ksq[WHITE], psq + NORTH)].result);
+
+            // poussée double
+            if (   SQ::rank(psq) == RANK_2
+                && psq + NORTH != ksq[WHITE]
+                && psq + NORTH != ksq[BLACK])
+                r = static_cast<Result>(r | db[index(BLACK, ksq[BLACK], ksq[WHITE], psq + 2*NORTH)].result);
+        }
+
+        return result = (r & Good) ? Good : (r & UNKNOWN) ? UNKNOWN : Bad;
+    }
+};
+
+//==========================================================
+//! \brief  Calcul de la bitbase
+//! Les positions inconnues sont classées itérativement,
+//! jusqu'à ce que plus aucune ne change.
+//----------------------------------------------------------
+void init()
+{
+    std::vector<KPKPosition> db;
+    db.reserve(MAX_INDEX);
+
+    for (int idx = 0; idx < MAX_INDEX; ++idx)
+        db.emplace_back(idx);
+
+    bool repeat = true;
+    while (repeat)
+    {
+        repeat = false;
+        for (int idx = 0; idx < MAX_INDEX; ++idx)
+            repeat |= (db[idx].result == UNKNOWN && db[idx].classify(db) != UNKNOWN);
+    }
+
+    for (int idx = 0; idx < MAX_INDEX; ++idx)
+        if (db[idx].result == WIN)
+            KPKBitbase[idx / 32] |= 1U << (idx & 0x1F);
+}
+
+//==========================================================
+//! \brief  Recherche d'une position dans la bitbase
+//! \param[in]  wksq    roi blanc
+//! \param[in]  wpsq    pion blanc (colonnes A à D)
+//! \param[in]  bksq    roi noir
+//! \param[in]  stm     camp au trait
+//! \return true si la position est gagnante pour les blancs
+//----------------------------------------------------------
+bool probe_kpk(int wksq, int wpsq, int bksq, Color stm)
+{
+    int idx = index(stm, bksq, wksq, wpsq);
+    return KPKBitbase[idx / 32] & (1U << (idx & 0x1F));
+}
+
+} // namespace
@@ -20,10 +20,11 @@
 #define USE_LATE_MOVE_PRUNING
 #define USE_SINGULAR_EXTENSION
 #define USE_LATE_MOVE_REDUCTION
+#define USE_QUIESCENCE_CHECKS
 
 #define USE_TC_WEISS
 
-//#define USE_ACC
+#define USE_NNUE
 
 // NE PAS UTILISER PRETTY avec
 //      + Arena (score mal affiché)
@@ -54,20 +55,25 @@ using Score = int;  // Valeur spéciale contenant à la fois mg et eg
 
 static constexpr int MAX_PLY    = 128;     // profondeur max de recherche (en demi-coups)
 static constexpr int MAX_HIST   = 800;     // longueur max de la partie (en demi-coups)
-static constexpr int MAX_MOVES  = 400;     // Number of moves in the candidate move array.
+static constexpr int MAX_MOVES  = 256;     // Number of moves in the candidate move array (218 coups légaux au maximum).
 static constexpr int MAX_TIME   = 60*60*1000;   // 1 heure en ms
 
 static constexpr int HASH_SIZE      = 128;      // en Mo , 128 ?
 static constexpr int MIN_HASH_SIZE  = 1;
-static constexpr int MAX_HASH_SIZE  = 1024;
-static constexpr int PAWN_HASH_SIZE = 64;       // en Ko
+static constexpr int MAX_HASH_SIZE  = 131072;   // 128 Go
+static constexpr int PAWN_HASH_SIZE     = 1024;     // en Ko, pour chaque thread
+static constexpr int MIN_PAWN_HASH_SIZE = 64;
+static constexpr int MAX_PAWN_HASH_SIZE = 65536;
+static constexpr int PERFT_HASH_SIZE    = 256;      // en Mo, table partagée par les threads du perft
 
 static constexpr int MAX_THREADS    = 32;
+static constexpr int MAX_MULTIPV    = 64;      // nombre max de variations affichées
 
 static constexpr int MATE           = 31000;
 static constexpr int MATE_IN_X      = MATE - MAX_PLY;
 static constexpr int TBWIN          = 30000;
 static constexpr int TBWIN_IN_X     = TBWIN - MAX_PLY;
+static constexpr int KNOWN_WIN      = 10000;        // finale connue gagnante (voir endgame.cpp)
 
 static constexpr int INFINITE       = MATE + 1;
 static constexpr int NOSCORE        = MATE + 2;     // ne peut jamais être atteint
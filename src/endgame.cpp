@@ -0,0 +1,362 @@
+#include "Board.h"
+#include "defines.h"
+#include "evaluate.h"
+#include "Material.h"
+
+//  Evaluation liée au matériel, et évaluateurs spécialisés
+//  pour les finales connues.
+//  Code inspiré de Stockfish (material.cpp, endgame.cpp)
+
+namespace {
+
+//! \brief  Distance d'une coordonnée au bord de l'échiquier
+constexpr int edge_distance(int x) { return std::min(x, 7 - x); }
+
+//! \brief  Bonus pour repousser le roi vers le bord
+inline int push_to_edge(int sq)
+{
+    int rd = edge_distance(SQ::rank(sq));
+    int fd = edge_distance(SQ::file(sq));
+    return 90 - (7 * fd * fd / 2 + 7 * rd * rd / 2);
+}
+
+//! \brief  Bonus pour repousser le roi vers les coins a1 et h8
+inline int push_to_corner(int sq) { return std::abs(7 - SQ::rank(sq) - SQ::file(sq)); }
+
+//! \brief  Bonus pour rapprocher les 2 rois
+inline int push_close(int sq1, int sq2) { return 140 - 20 * distance_between(sq1, sq2); }
+
+}
+
+//==========================================================
+//! \brief  Signature du matériel
+//! Nombre de pièces de chaque type (pion à dame) et de
+//! chaque couleur, sur 4 bits chacun.
+//! Elle est tenue à jour dans make_move.
+//----------------------------------------------------------
+U64 Board::material_key() const noexcept
+{
+    return mat_key;
+}
+
+//==========================================================
+//! \brief  Calcul complet du matériel et de la position
+//! Sert uniquement à vérifier les valeurs incrémentales
+//! (voir Board::valid)
+//----------------------------------------------------------
+void Board::calculate_psqt(Score& score, U64& key) const noexcept
+{
+    score = 0;
+    key   = 0;
+
+    for (int sq = 0; sq < N_SQUARES; sq++)
+    {
+        if (pieceOn[sq] == NO_TYPE)
+            continue;
+        Color c = (colorPiecesBB[WHITE] & BB::sq2BB(sq)) ? WHITE : BLACK;
+        score += psqt_value(c, pieceOn[sq], sq);
+        if (pieceOn[sq] != KING)
+            key += material_unit(c, pieceOn[sq]);
+    }
+}
+
+//==========================================================
+//! \brief  Calcul de tout ce qui ne dépend que du matériel
+//! \param[in]  key     signature du matériel
+//! \param[out] me      entrée de la table du matériel
+//----------------------------------------------------------
+void Board::compute_material(U64 key, MaterialEntry& me)
+{
+    int count[N_COLORS][N_PIECES] = {};
+    int minors[N_COLORS];
+    int pieces[N_COLORS];
+
+    for (int c = WHITE; c <= BLACK; c++)
+    {
+        for (int pt = PAWN; pt <= QUEEN; pt++)
+            count[c][pt] = (key >> (4 * (5*c + pt - PAWN))) & 0x0F;
+        minors[c] = count[c][KNIGHT] + count[c][BISHOP];
+        pieces[c] = minors[c] + count[c][ROOK] + count[c][QUEEN];
+    }
+
+    me.key      = key;
+    me.endgame  = EG_NONE;
+    me.strong   = WHITE;
+
+    // Phase de la partie
+    me.phase24 =  4 * (count[WHITE][QUEEN]  + count[BLACK][QUEEN])
+                + 2 * (count[WHITE][ROOK]   + count[BLACK][ROOK])
+                +     (count[WHITE][BISHOP] + count[BLACK][BISHOP])
+                +     (count[WHITE][KNIGHT] + count[BLACK][KNIGHT]);
+
+    // Paire de fous
+    // On ne teste pas si les fous sont de couleur différente !
+    me.imbalance = (count[WHITE][BISHOP] >= 2 ? BishopPair : 0)
+                 - (count[BLACK][BISHOP] >= 2 ? BishopPair : 0);
+
+    // Scale down eval the fewer pawns the stronger side has
+    for (int c = WHITE; c <= BLACK; c++)
+    {
+        int x = 8 - count[c][PAWN];
+        me.scale[c] = 128 - x * x;
+    }
+
+    // Fous de couleur opposée : la couleur des cases
+    // sera vérifiée lors de l'évaluation
+    me.ocb =   pieces[WHITE] == 1 && count[WHITE][BISHOP] == 1
+            && pieces[BLACK] == 1 && count[BLACK][BISHOP] == 1;
+
+    // Nullité par manque de matériel : pas de pion,
+    // et au plus une pièce mineure de chaque côté ;
+    // ou bien 2 cavaliers contre le roi seul
+    bool no_pawns = (count[WHITE][PAWN] + count[BLACK][PAWN]) == 0;
+    me.draw =   no_pawns
+             && (   (pieces[WHITE] <= 1 && minors[WHITE] == pieces[WHITE]
+                  && pieces[BLACK] <= 1 && minors[BLACK] == pieces[BLACK])
+                 || (pieces[WHITE] == 0 && pieces[BLACK] == 2 && count[BLACK][KNIGHT] == 2)
+                 || (pieces[BLACK] == 0 && pieces[WHITE] == 2 && count[WHITE][KNIGHT] == 2));
+
+    // Finales sans pion difficiles à gagner (voir Sjeng)
+    if (material_draw())
+    {
+        me.scale[WHITE] = std::min(me.scale[WHITE], 32);
+        me.scale[BLACK] = std::min(me.scale[BLACK], 32);
+    }
+
+    // Choix d'un évaluateur spécialisé
+    for (Color s : {WHITE, BLACK})
+    {
+        Color w = ~s;
+
+        if (pieces[w] == 0 && count[w][PAWN] == 0)
+        {
+            if (pieces[s] == 0 && count[s][PAWN] == 1)
+                me.endgame = EG_KPK;
+            else if (   count[s][PAWN] == 0 && pieces[s] == 2
+                     && count[s][KNIGHT] == 1 && count[s][BISHOP] == 1)
+                me.endgame = EG_KBNK;
+            else if (   count[s][QUEEN] || count[s][ROOK]
+                     || (count[s][BISHOP] && count[s][KNIGHT])
+                     || count[s][BISHOP] >= 2)
+                me.endgame = EG_KXK;
+        }
+        else if (   pieces[s] == 1 && count[s][ROOK] == 1 && count[s][PAWN] == 0
+                 && pieces[w] == 0 && count[w][PAWN] == 1)
+        {
+            me.endgame = EG_KRKP;
+        }
+
+        if (me.endgame != EG_NONE)
+        {
+            me.strong = s;
+            break;
+        }
+    }
+}
+
+//==========================================================
+//! \brief  Recherche ou calcul de l'entrée du matériel
+//! \param[in]  local   entrée utilisée s'il n'y a pas de table
+//----------------------------------------------------------
+const MaterialEntry* Board::probe_material(MaterialEntry& local)
+{
+    U64 key = material_key();
+
+    // On ne peut pas utiliser la table lors d'un tuning
+#if defined USE_TUNER
+    compute_material(key, local);
+    return &local;
+#else
+
+    if (material_cache == nullptr)
+    {
+        compute_material(key, local);
+        return &local;
+    }
+
+    MaterialEntry* entry = material_cache->entry(key);
+    if (entry->key != key)
+        compute_material(key, *entry);
+    return entry;
+#endif
+}
+
+//==========================================================
+//! \brief  Evaluation d'une finale connue
+//! \return score du point de vue du camp au trait
+//----------------------------------------------------------
+int Board::evaluate_endgame(const MaterialEntry* me)
+{
+    int result = 0;
+
+    if (me->strong == WHITE)
+    {
+        switch (me->endgame)
+        {
+        case EG_KXK:  result = evaluate_KXK<WHITE>();  break;
+        case EG_KBNK: result = evaluate_KBNK<WHITE>(); break;
+        case EG_KPK:  result = evaluate_KPK<WHITE>();  break;
+        case EG_KRKP: result = evaluate_KRKP<WHITE>(); break;
+        default: break;
+        }
+    }
+    else
+    {
+        switch (me->endgame)
+        {
+        case EG_KXK:  result = evaluate_KXK<BLACK>();  break;
+        case EG_KBNK: result = evaluate_KBNK<BLACK>(); break;
+        case EG_KPK:  result = evaluate_KPK<BLACK>();  break;
+        case EG_KRKP: result = evaluate_KRKP<BLACK>(); break;
+        default: break;
+        }
+    }
+
+    return (side_to_move == me->strong) ? result : -result;
+}
+
+//==========================================================
+//! \brief  Matériel suffisant contre le roi seul
+//! On repousse le roi faible au bord, et on en rapproche
+//! le roi fort.
+//! \return score du point de vue du camp fort
+//----------------------------------------------------------
+template <Color S>
+int Board::evaluate_KXK()
+{
+    constexpr Color W = ~S;
+
+    // Pat : le camp faible n'a aucun coup
+    if (side_to_move == W)
+    {
+        MoveList ml;
+        legal_moves<W>(ml);
+        if (ml.count == 0)
+            return 0;
+    }
+
+    int winner = x_king[S];
+    int loser  = x_king[W];
+
+    int result =  BB::count_bit(occupancy_cp<S, PAWN>())   * P_EG
+                + BB::count_bit(occupancy_cp<S, KNIGHT>()) * N_EG
+                + BB::count_bit(occupancy_cp<S, BISHOP>()) * B_EG
+                + BB::count_bit(occupancy_cp<S, ROOK>())   * R_EG
+                + BB::count_bit(occupancy_cp<S, QUEEN>())  * Q_EG
+                + push_to_edge(loser)
+                + push_close(winner, loser);
+
+    Bitboard bishops = occupancy_cp<S, BISHOP>();
+    if (   occupancy_cp<S, QUEEN>() || occupancy_cp<S, ROOK>()
+        || (bishops && occupancy_cp<S, KNIGHT>())
+        || ((bishops & DarkSquares) && (bishops & ~DarkSquares)))
+        result = std::min(result + KNOWN_WIN, TBWIN_IN_X - 1);
+
+    return result;
+}
+
+//==========================================================
+//! \brief  Fou + Cavalier contre roi seul
+//! Le roi faible doit être repoussé vers un coin
+//! de la couleur du fou.
+//! \return score du point de vue du camp fort
+//----------------------------------------------------------
+template <Color S>
+int Board::evaluate_KBNK()
+{
+    int winner = x_king[S];
+    int loser  = x_king[~S];
+    int bishop = BB::get_lsb(occupancy_cp<S, BISHOP>());
+
+    // push_to_corner pousse vers a1 et h8, qui sont des cases noires
+    if (!BB::test_bit(DarkSquares, bishop))
+        loser ^= 7;
+
+    return KNOWN_WIN + 3520 + push_close(winner, loser) + 420 * push_to_corner(loser);
+}
+
+//==========================================================
+//! \brief  Roi + Pion contre Roi
+//! Utilisation de la bitbase
+//! \return score du point de vue du camp fort
+//----------------------------------------------------------
+template <Color S>
+int Board::evaluate_KPK()
+{
+    int wksq = x_king[S];
+    int bksq = x_king[~S];
+    int psq  = BB::get_lsb(occupancy_cp<S, PAWN>());
+
+    // On se ramène au cas d'un pion blanc sur les colonnes A à D
+    if (S == BLACK)
+    {
+        wksq = SQ::flip_square(wksq);
+        bksq = SQ::flip_square(bksq);
+        psq  = SQ::flip_square(psq);
+    }
+    if (SQ::file(psq) >= FILE_E)
+    {
+        wksq ^= 7;
+        bksq ^= 7;
+        psq  ^= 7;
+    }
+
+    Color stm = (side_to_move == S) ? WHITE : BLACK;
+
+    if (!Bitbase::probe_kpk(wksq, psq, bksq, stm))
+        return 0;
+
+    return KNOWN_WIN + P_EG + SQ::rank(psq);
+}
+
+//==========================================================
+//! \brief  Tour contre Pion
+//! \return score du point de vue du camp fort
+//----------------------------------------------------------
+template <Color S>
+int Board::evaluate_KRKP()
+{
+    constexpr Color W = ~S;
+
+    // Cases relatives au camp fort : le pion descend
+    int wksq = SQ::relative_square<S>(x_king[S]);
+    int bksq = SQ::relative_square<S>(x_king[W]);
+    int rsq  = SQ::relative_square<S>(BB::get_lsb(occupancy_cp<S, ROOK>()));
+    int psq  = SQ::relative_square<S>(BB::get_lsb(occupancy_cp<W, PAWN>()));
+
+    int queening = SQ::square(SQ::file(psq), RANK_1);
+    int result;
+
+    // Le roi fort est devant le pion : gain
+    if (SQ::file(wksq) == SQ::file(psq) && SQ::rank(wksq) < SQ::rank(psq))
+        result = R_EG - distance_between(wksq, psq);
+
+    // Le roi faible est trop loin du pion et de la tour : gain
+    else if (   distance_between(bksq, psq) >= 3 + (side_to_move == W)
+             && distance_between(bksq, rsq) >= 3)
+        result = R_EG - distance_between(wksq, psq);
+
+    // Le pion est avancé et soutenu par son roi : nulle probable
+    else if (   SQ::rank(bksq) <= RANK_3
+             && distance_between(bksq, psq) == 1
+             && SQ::rank(wksq) >= RANK_4
+             && distance_between(wksq, psq) > 2 + (side_to_move == S))
+        result = 80 - 8 * distance_between(wksq, psq);
+
+    else
+        result = 200 - 8 * (  distance_between(wksq, psq + SOUTH)
+                            - distance_between(bksq, psq + SOUTH)
+                            - distance_between(psq, queening));
+
+    return result;
+}
+
+// Explicit instantiations.
+template int Board::evaluate_KXK<WHITE>();
+template int Board::evaluate_KXK<BLACK>();
+template int Board::evaluate_KBNK<WHITE>();
+template int Board::evaluate_KBNK<BLACK>();
+template int Board::evaluate_KPK<WHITE>();
+template int Board::evaluate_KPK<BLACK>();
+template int Board::evaluate_KRKP<WHITE>();
+template int Board::evaluate_KRKP<BLACK>();
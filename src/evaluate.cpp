@@ -1,7 +1,9 @@
 #include "Board.h"
 #include "defines.h"
 #include "evaluate.h"
-#include "TranspositionTable.h"
+#include "PawnCache.h"
+#include "Material.h"
+#include "NNUE.h"
 
 #if defined USE_TUNER
 #include "Tuner.h"
@@ -23,16 +25,42 @@ https://hxim.github.io/Stockfish-Evaluation-Guide/
 {
     Score eval = 0;
     EvalInfo ei;
+    MaterialEntry local;
 
-    // nullité
-    // On utilise les tables Syzygy, ce test de nullité est inutile
+    // Données liées au matériel
+    const MaterialEntry* me = probe_material(local);
 
-    // voir le code de Sjeng (aussi Fruit-Mora), qui comporte un test s'il reste des pions
-//    if (material_draw() == true)
-//        return 0;
+#if !defined USE_TUNER
+    // nullité par manque de matériel
+    if (me->draw)
+        return 0;
+
+    // finales connues
+    if (me->endgame != EG_NONE)
+        return evaluate_endgame(me);
+
+#if defined USE_NNUE
+    // réseau de neurones, s'il a été chargé
+    if (nnue.is_loaded())
+        return evaluate_nnue();
+#endif
+#endif
 
     // Initialisations
     init_eval_info(ei);
+    ei.phase24 = me->phase24;
+
+    //--------------------------------
+    //  Déséquilibre matériel
+    //--------------------------------
+    eval += me->imbalance;
+
+#if !defined USE_TUNER
+    //--------------------------------
+    //  Matériel et position
+    //--------------------------------
+    eval += psqt;
+#endif
 
     //--------------------------------
     //  Evaluation des pions
@@ -59,7 +87,7 @@ https://hxim.github.io/Stockfish-Evaluation-Guide/
 #endif
 
     // Adjust eval by scale factor
-    int scale = scale_factor(eval);
+    int scale = scale_factor(me, eval);
 #if defined USE_TUNER
     ownTuner.Trace.scale = scale;
 #endif
@@ -86,11 +114,15 @@ Score Board::probe_pawn_cache(EvalInfo& ei)
     return (evaluate_pawns<WHITE>(ei) - evaluate_pawns<BLACK>(ei));
 #else
 
+    // Pas de table (hors recherche)
+    if (pawn_cache == nullptr)
+        return (evaluate_pawns<WHITE>(ei) - evaluate_pawns<BLACK>(ei));
+
     Score eval = 0;
     Bitboard passed_pawns;
 
     // Recherche de la position des pions dans le cache
-    if (transpositionTable.probe_pawn_table(pawn_hash, eval, passed_pawns) == true)
+    if (pawn_cache->probe(pawn_hash, eval, passed_pawns) == true)
     {
         // La table de pions contient la position,
         // On récupère l'évaluation de la table
@@ -101,7 +133,7 @@ Score Board::probe_pawn_cache(EvalInfo& ei)
         // La table de pions ne contient pas la position,
         // on calcule l'évaluation, et on la stocke
         eval = evaluate_pawns<WHITE>(ei) - evaluate_pawns<BLACK>(ei);
-        transpositionTable.store_pawn_table(pawn_hash, eval, ei.passedPawns);   //TODO passedPawns = ???
+        pawn_cache->store(pawn_hash, eval, ei.passedPawns);   //TODO passedPawns = ???
     }
 
     return eval;
@@ -216,13 +248,14 @@ Score Board::evaluate_pawns(EvalInfo& ei)
     {
         sq    = BB::pop_lsb(bb);                   // case où est la pièce
         sqpos = SQ::relative_square<US>(sq);               // case inversée pour les tables
-        eval += PawnValue;                         // score matériel
-        eval += PawnPSQT[sqpos];                   // score positionnel
 
 #if defined DEBUG_EVAL
             //            printf("le pion %s (%d) sur la case %s a une valeur MG de %d \n", side_name[US].c_str(), Us, square_name[sq].c_str(), mg_pawn_table[sqpos]);
 #endif
 #if defined USE_TUNER
+        // matériel et position : voir Board::psqt, mis à jour dans make_move
+        eval += PawnValue;                         // score matériel
+        eval += PawnPSQT[sqpos];                   // score positionnel
         ownTuner.Trace.PawnValue[US]++;
         ownTuner.Trace.PawnPSQT[sqpos][US]++;
 #endif
@@ -355,13 +388,12 @@ Score Board::evaluate_knights(EvalInfo& ei)
     constexpr Color THEM = ~US;
     constexpr Direction DOWN = (US == WHITE) ? SOUTH : NORTH;
 
-    int sq, sqpos;
+    int sq;
     int count;
     Score eval = 0;
     int defended;
 
     Bitboard bb = ei.knights[US];
-    ei.phase24 += BB::count_bit(bb);
     Bitboard     enemyPawns = ei.pawns[THEM];
 
     // Le cavalier est protégé par un pion
@@ -380,11 +412,11 @@ Score Board::evaluate_knights(EvalInfo& ei)
     while (bb)
     {
         sq    = BB::pop_lsb(bb);                   // case où est la pièce
-        sqpos = SQ::relative_square<US>(sq);           // case inversée pour les tables
+#if defined USE_TUNER
+        // matériel et position : voir Board::psqt, mis à jour dans make_move
+        int sqpos = SQ::relative_square<US>(sq);           // case inversée pour les tables
         eval += KnightValue;                    // score matériel
         eval += KnightPSQT[sqpos];              // score positionnel
-
-#if defined USE_TUNER
         ownTuner.Trace.KnightValue[US]++;
         ownTuner.Trace.KnightPSQT[sqpos][US]++;
 #endif
@@ -453,7 +485,7 @@ Score Board::evaluate_bishops(EvalInfo& ei)
     constexpr Color THEM = ~US;
     constexpr Direction DOWN = (US == WHITE) ? SOUTH : NORTH;
 
-    int sq, sqpos;
+    int sq;
     int count;
 
     Bitboard bishopSquares;
@@ -462,20 +494,12 @@ Score Board::evaluate_bishops(EvalInfo& ei)
 
     Score    eval = 0;
     Bitboard bb   = ei.bishops[US];
-    ei.phase24 += BB::count_bit(bb);
 
-    // Paire de fous
-    // On ne teste pas si les fous sont de couleur différente !
-    if (BB::count_bit(bb) >= 2)
-    {
-        eval += BishopPair;
-#if defined DEBUG_EVAL
-        printf("Le camp %s possède la paire de fous \n", side_name[US].c_str());
-#endif
+    // Paire de fous : elle est comptée avec le matériel (compute_material)
 #if defined USE_TUNER
+    if (BB::count_bit(bb) >= 2)
         ownTuner.Trace.BishopPair[US]++;
 #endif
-    }
 
     // Le fou est protégé par un pion
     // Il ne peut pas être attaqué par une tour
@@ -493,11 +517,11 @@ Score Board::evaluate_bishops(EvalInfo& ei)
     while (bb)
     {
         sq    = BB::pop_lsb(bb);                   // case où est la pièce
-        sqpos = SQ::relative_square<US>(sq);               // case inversée pour les tables
+#if defined USE_TUNER
+        // matériel et position : voir Board::psqt, mis à jour dans make_move
+        int sqpos = SQ::relative_square<US>(sq);               // case inversée pour les tables
         eval += BishopValue;                       // score matériel
         eval += BishopPSQT[sqpos];                 // score positionnel
-
-#if defined USE_TUNER
         ownTuner.Trace.BishopValue[US]++;
         ownTuner.Trace.BishopPSQT[sqpos][US]++;
 #endif
@@ -551,21 +575,20 @@ Score Board::evaluate_rooks(EvalInfo& ei)
 {
     constexpr Color THEM = ~US;
 
-    int sq, sqpos;
+    int sq;
     int count;
     Score eval = 0;
 
     Bitboard bb = ei.rooks[US];
-    ei.phase24 += 2*BB::count_bit(bb);
 
     while (bb)
     {
         sq     = BB::pop_lsb(bb);                   // case où est la pièce
-        sqpos  = SQ::relative_square<US>(sq);               // case inversée pour les tables
+#if defined USE_TUNER
+        // matériel et position : voir Board::psqt, mis à jour dans make_move
+        int sqpos = SQ::relative_square<US>(sq);               // case inversée pour les tables
         eval += RookValue;                         // score matériel
         eval += RookPSQT[sqpos];                   // score positionnel
-
-#if defined USE_TUNER
         ownTuner.Trace.RookValue[US]++;
         ownTuner.Trace.RookPSQT[sqpos][US]++;
 #endif
@@ -638,20 +661,19 @@ Score Board::evaluate_queens(EvalInfo& ei)
 {
     constexpr Color THEM = ~US;
 
-    int sq, sqpos;
+    int sq;
     int count;
     Score eval = 0;
     Bitboard bb = ei.queens[US];
-    ei.phase24 += 4*BB::count_bit(bb);
 
     while (bb)
     {
         sq     = BB::pop_lsb(bb);                   // case où est la pièce
-        sqpos  = SQ::relative_square<US>(sq);               // case inversée pour les tables
+#if defined USE_TUNER
+        // matériel et position : voir Board::psqt, mis à jour dans make_move
+        int sqpos = SQ::relative_square<US>(sq);               // case inversée pour les tables
         eval += QueenValue;                        // score matériel
         eval += QueenPSQT[sqpos];                  // score positionnel
-
-#if defined USE_TUNER
         ownTuner.Trace.QueenValue[US]++;
         ownTuner.Trace.QueenPSQT[sqpos][US]++;
 #endif
@@ -694,14 +716,14 @@ Score Board::evaluate_king(EvalInfo& ei)
 {
     constexpr Color THEM = ~US;
 
-    int sq, sqpos;
+    int sq;
     Score eval = 0;
     sq     = x_king[US];
-    sqpos  = SQ::relative_square<US>(sq);               // case inversée pour les tables
+#if defined USE_TUNER
+    // matériel et position : voir Board::psqt, mis à jour dans make_move
+    int sqpos = SQ::relative_square<US>(sq);               // case inversée pour les tables
     eval += KingValue;                         // score matériel
     eval += KingPSQT[sqpos];                   // score positionnel
-
-#if defined USE_TUNER
     ownTuner.Trace.KingPSQT[sqpos][US]++;
 #endif
 
@@ -857,24 +879,15 @@ bool Board::material_draw(void)
 }
 
 // Calculate scale factor to lower overall eval based on various features
-int Board::scale_factor(const Score eval)
+// La partie ne dépendant que du matériel est calculée par compute_material
+int Board::scale_factor(const MaterialEntry* me, const Score eval)
 {
     // Scale down eval for opposite-colored bishops endgames
-    if (   !typePiecesBB[QUEEN]
-        && !typePiecesBB[ROOK]
-        && !typePiecesBB[KNIGHT]
-        && non_pawn_count<WHITE>() == 1
-        && non_pawn_count<BLACK>() == 1
-        && (BB::single(typePiecesBB[BISHOP] & DarkSquares)))
+    if (me->ocb && (BB::single(typePiecesBB[BISHOP] & DarkSquares)))
         return 64;
 
     // Scale down eval the fewer pawns the stronger side has
-    //    Color strong = eval > 0 ? WHITE : BLACK;
-    int strongPawnCount = eval > 0 ? BB::count_bit(occupancy_cp<WHITE, PAWN>())
-                                   : BB::count_bit(occupancy_cp<BLACK, PAWN>());
-    int x = 8 - strongPawnCount;
-    return 128 - x * x;
-
+    return eval > 0 ? me->scale[WHITE] : me->scale[BLACK];
 }
 
 //=============================================================
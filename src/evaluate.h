@@ -229,6 +229,22 @@ constexpr Score QueenMobility[28] = {
 
 //============================================================== FIN TUNER
 
+//------------------------------------------------------------
+//  Matériel et position, tenus à jour dans make_move (voir Board::psqt)
+constexpr Score PieceValue[N_PIECES] = {
+    0, PawnValue, KnightValue, BishopValue, RookValue, QueenValue, KingValue
+};
+constexpr const Score* PieceSquare[N_PIECES] = {
+    nullptr, PawnPSQT, KnightPSQT, BishopPSQT, RookPSQT, QueenPSQT, KingPSQT
+};
+
+//! \brief Valeur (matériel + position) d'une pièce, du point de vue des Blancs
+constexpr Score psqt_value(Color c, int piece, int sq)
+{
+    return c == WHITE ?   PieceValue[piece] + PieceSquare[piece][sq]
+                      : -(PieceValue[piece] + PieceSquare[piece][sq ^ 56]);
+}
+
 //  Sécurité du Roi
 constexpr Score AttackPower[7]   = { 0, 0,  35, 20, 40, 80, 0 };
 constexpr Score CheckPower[7]    = { 0, 0, 100, 35, 65, 65, 0 };
@@ -0,0 +1,184 @@
+#include "Board.h"
+#include "Attacks.h"
+#include "Move.h"
+
+constexpr int PUSH[] = {8, -8};
+
+//=================================================================
+//! \brief  Retourne la ligne (rangée, colonne, diagonale)
+//! passant par la case sq, dans la direction d (voir allmask)
+//-----------------------------------------------------------------
+static Bitboard line_mask(const int sq, const int d)
+{
+    switch (d)
+    {
+    case 1: return RankMask64[sq];
+    case 8: return FileMask64[sq];
+    case 9: return DiagonalMask64[sq];
+    case 7: return AntiDiagonalMask64[sq];
+    default: return 0;
+    }
+}
+
+//=================================================================
+//! \brief  Génération des coups tranquilles donnant échec
+//!             + échecs directs
+//!             + échecs à la découverte
+//!         Ni capture, ni promotion, ni roque.
+//!
+//! Le camp C ne doit pas être en échec (utilisé par la Quiescence).
+//!
+//! \param  ml  Liste des coups dans laquelle on va stocker les coups
+//-----------------------------------------------------------------
+template <Color C>
+constexpr void Board::legal_quiet_checks(MoveList& ml) noexcept
+{
+    constexpr Color Them = ~C;
+    const int K  = king_square<C>();
+    const int EK = king_square<Them>();
+
+    const Bitboard occupiedBB = occupancy_all();     // toutes les pièces (Blanches + Noires)
+    const Bitboard emptyBB    = ~occupiedBB;
+    const Bitboard usBB       = colorPiecesBB[C];
+
+    int s;
+    Bitboard b1;
+
+    //-----------------------------------------------------------------------------------------
+    //  Pièces clouées sur notre roi (voir legal_moves)
+    //-----------------------------------------------------------------------------------------
+    Bitboard candidates = (Attacks::rook_moves(K, colorPiecesBB[Them])   & orthogonal_sliders<Them>()) |
+                          (Attacks::bishop_moves(K, colorPiecesBB[Them]) & diagonal_sliders<Them>());
+
+    Bitboard pinnedBB = 0;
+    while (candidates)
+    {
+        s  = BB::pop_lsb(candidates);
+        b1 = squares_between(K, s) & usBB;
+
+        if (b1 && (b1 & (b1 - 1)) == 0)
+            pinnedBB |= b1;
+    }
+
+    //-----------------------------------------------------------------------------------------
+    //  Pièces masquant une de nos pièces glissantes sur le roi adverse :
+    //  leur déplacement hors de la ligne donne un échec à la découverte
+    //-----------------------------------------------------------------------------------------
+    candidates = (Attacks::rook_moves(EK, colorPiecesBB[Them])   & orthogonal_sliders<C>()) |
+                 (Attacks::bishop_moves(EK, colorPiecesBB[Them]) & diagonal_sliders<C>());
+
+    Bitboard discoverBB = 0;
+    while (candidates)
+    {
+        s  = BB::pop_lsb(candidates);
+        b1 = squares_between(EK, s) & occupiedBB;
+
+        if ((b1 & usBB) && (b1 & (b1 - 1)) == 0)
+            discoverBB |= b1;
+    }
+
+    //-----------------------------------------------------------------------------------------
+    //  Cases donnant un échec direct
+    //-----------------------------------------------------------------------------------------
+    const Bitboard pawn_checks   = Attacks::pawn_attacks<Them>(EK);
+    const Bitboard knight_checks = Attacks::knight_moves(EK);
+    const Bitboard bishop_checks = Attacks::bishop_moves(EK, occupiedBB);
+    const Bitboard rook_checks   = Attacks::rook_moves(EK, occupiedBB);
+
+    const int *dir  = allmask[K].direction;
+    const int *edir = allmask[EK].direction;
+
+    // Cases d'arrivée autorisées pour la pièce en "from" :
+    //  + échec direct, ou découverte (en quittant la ligne du roi adverse)
+    //  + pièce clouée : elle reste sur la ligne de notre roi
+    auto targets = [&](const int from, const Bitboard checks) {
+        Bitboard mask = checks;
+        if (discoverBB & BB::sq2BB(from))
+            mask |= ~line_mask(from, edir[from]);
+        if (pinnedBB & BB::sq2BB(from))
+            mask &= line_mask(from, dir[from]);
+        return mask & emptyBB;
+    };
+
+    Bitboard pieceBB;
+    Bitboard attackBB;
+    int from, to;
+
+    ml.clear();
+
+    // pawn : poussées simples et doubles, hors promotion
+    pieceBB = occupancy_cp<C, PAWN>();
+    while (pieceBB)
+    {
+        from = BB::pop_lsb(pieceBB);
+        to   = from + PUSH[C];
+
+        if (!(emptyBB & BB::sq2BB(to)) || SQ::is_promotion<C>(to))
+            continue;
+
+        const Bitboard mask = targets(from, pawn_checks);
+        if (mask & BB::sq2BB(to))
+            add_quiet_move(ml, from, to, PAWN, Move::FLAG_NONE);
+
+        to += PUSH[C];
+        if (SQ::is_on_second_rank<C>(from) && (mask & BB::sq2BB(to)))
+            add_quiet_move(ml, from, to, PAWN, Move::FLAG_DOUBLE);
+    }
+
+    // knight : un cavalier cloué ne peut pas bouger
+    pieceBB = occupancy_cp<C, KNIGHT>() & ~pinnedBB;
+    while (pieceBB)
+    {
+        from     = BB::pop_lsb(pieceBB);
+        attackBB = Attacks::knight_moves(from) & targets(from, knight_checks);
+        push_piece_quiet_moves(ml, attackBB, from, KNIGHT);
+    }
+
+    // bishop
+    pieceBB = occupancy_cp<C, BISHOP>();
+    while (pieceBB)
+    {
+        from     = BB::pop_lsb(pieceBB);
+        attackBB = Attacks::bishop_moves(from, occupiedBB) & targets(from, bishop_checks);
+        push_piece_quiet_moves(ml, attackBB, from, BISHOP);
+    }
+
+    // rook
+    pieceBB = occupancy_cp<C, ROOK>();
+    while (pieceBB)
+    {
+        from     = BB::pop_lsb(pieceBB);
+        attackBB = Attacks::rook_moves(from, occupiedBB) & targets(from, rook_checks);
+        push_piece_quiet_moves(ml, attackBB, from, ROOK);
+    }
+
+    // queen
+    pieceBB = occupancy_cp<C, QUEEN>();
+    while (pieceBB)
+    {
+        from     = BB::pop_lsb(pieceBB);
+        attackBB = Attacks::queen_moves(from, occupiedBB) & targets(from, bishop_checks | rook_checks);
+        push_piece_quiet_moves(ml, attackBB, from, QUEEN);
+    }
+
+    // king : uniquement les échecs à la découverte
+    if (discoverBB & BB::sq2BB(K))
+    {
+        // on enlève le roi de l'échiquier (voir legal_moves)
+        colorPiecesBB[C] ^= BB::sq2BB(K);
+
+        Bitboard mask = Attacks::king_moves(K) & targets(K, 0);
+        while (mask)
+        {
+            to = BB::pop_lsb(mask);
+            if (!square_attacked<Them>(to))
+                add_quiet_move(ml, K, to, KING, Move::FLAG_NONE);
+        }
+
+        colorPiecesBB[C] ^= BB::sq2BB(K);
+    }
+}
+
+// Explicit instantiations.
+template void Board::legal_quiet_checks<WHITE>(MoveList& ml) noexcept;
+template void Board::legal_quiet_checks<BLACK>(MoveList& ml) noexcept;
@@ -12,6 +12,7 @@ constexpr int PUSH[] = {8, -8};
 //!             + ni capture
 //!             + ni promotion
 //! \param  ml  Liste des coups dans laquelle on va stocker les coups
+//!             (à la suite des coups déjà présents)
 //!
 //! algorithme de Mperft
 //-----------------------------------------------------------------
@@ -80,8 +81,6 @@ constexpr void Board::legal_quiet(MoveList& ml) noexcept
 
     //-------------------------------------------------------------------------------------------
 
-    ml.clear();
-
     //    std::cout << "legal_gen 1 ; ch=%d " << BB::count_bit(checkersBB) << std::endl;
 
     // in check: capture or block the (single) checker if any;
@@ -0,0 +1,203 @@
+#include "Board.h"
+#include "Attacks.h"
+#include "Move.h"
+
+constexpr int PUSH[] = {8, -8};
+
+//=================================================================
+//! \brief  Détermine si un coup est pseudo-légal dans la position
+//!
+//! Le coup provient de la table de transposition, d'un killer
+//! ou d'un counter-move : il peut avoir été joué dans une autre position.
+//! On vérifie directement sur les bitboards que le coup est bien
+//! celui que produirait le générateur (même codage), sans
+//! contrôler que le roi reste hors d'échec (voir is_legal).
+//-----------------------------------------------------------------
+template <Color C>
+[[nodiscard]] bool Board::is_pseudo_legal(const MOVE move) const noexcept
+{
+    constexpr Color Them = ~C;
+
+    // coups nuls, ou portant des bits hors du codage (code TT)
+    if (move == Move::MOVE_NONE || (move & ~Move::MOVE_MOVE))
+        return false;
+
+    const int       from     = Move::from(move);
+    const int       dest     = Move::dest(move);
+    const PieceType piece    = Move::piece(move);
+    const PieceType captured = Move::captured(move);
+    const PieceType promo    = Move::promotion(move);
+    const U32       flags    = Move::flags(move);
+
+    const Bitboard occupiedBB = occupancy_all();
+    const Bitboard destBB     = BB::sq2BB(dest);
+
+    // la pièce jouée doit être à nous, et la case d'arrivée libre ou adverse
+    if (   !(colorPiecesBB[C] & BB::sq2BB(from))
+        || pieceOn[from] != piece
+        || (colorPiecesBB[C] & destBB))
+        return false;
+
+    //-------------------------------------------------- prise en passant
+    if (flags == Move::FLAG_ENPASSANT)
+    {
+        return(   piece == PAWN
+               && captured == PAWN
+               && promo == NO_TYPE
+               && dest == ep_square
+               && (Attacks::pawn_attacks<C>(from) & destBB));
+    }
+
+    // la pièce prise doit correspondre à l'occupant de la case d'arrivée
+    if (colorPiecesBB[Them] & destBB)
+    {
+        if (captured != pieceOn[dest] || captured == KING)
+            return false;
+    }
+    else if (captured != NO_TYPE)
+    {
+        return false;
+    }
+
+    //-------------------------------------------------- pions
+    if (piece == PAWN)
+    {
+        // une promotion est obligatoire sur la dernière rangée
+        if (SQ::is_promotion<C>(dest))
+        {
+            if (promo < KNIGHT || promo > QUEEN)
+                return false;
+        }
+        else if (promo != NO_TYPE)
+        {
+            return false;
+        }
+
+        if (flags == Move::FLAG_DOUBLE)
+        {
+            return(   SQ::is_on_second_rank<C>(from)
+                   && dest == from + 2 * PUSH[C]
+                   && !(occupiedBB & (BB::sq2BB(from + PUSH[C]) | destBB)));
+        }
+        if (flags != Move::FLAG_NONE)
+            return false;
+
+        if (captured != NO_TYPE)
+            return (Attacks::pawn_attacks<C>(from) & destBB);
+
+        return (dest == from + PUSH[C]);
+    }
+
+    if (promo != NO_TYPE)
+        return false;
+
+    //-------------------------------------------------- roque
+    if (flags == Move::FLAG_CASTLE)
+    {
+        if (piece != KING || from != castle_king_from[C] || captured != NO_TYPE)
+            return false;
+
+        int rook_from, rook_to;
+        if (dest == ksc_castle_king_to[C] && can_castle_k<C>())
+        {
+            rook_from = ksc_castle_rook_from[C];
+            rook_to   = ksc_castle_rook_to[C];
+        }
+        else if (dest == qsc_castle_king_to[C] && can_castle_q<C>())
+        {
+            rook_from = qsc_castle_rook_from[C];
+            rook_to   = qsc_castle_rook_to[C];
+        }
+        else
+        {
+            return false;
+        }
+
+        // mêmes conditions que le générateur (voir legal_moves)
+        const Bitboard blockers  = occupiedBB ^ BB::sq2BB(from) ^ BB::sq2BB(rook_from);
+        const Bitboard king_path = squares_between(from, dest) | destBB;
+        const Bitboard rook_path = squares_between(rook_to, rook_from) | BB::sq2BB(rook_to);
+
+        return BB::empty((king_path | rook_path) & blockers);
+    }
+
+    if (flags != Move::FLAG_NONE)
+        return false;
+
+    //-------------------------------------------------- autres pièces
+    switch (piece)
+    {
+    case KNIGHT:
+        return (Attacks::knight_moves(from) & destBB);
+    case BISHOP:
+        return (Attacks::bishop_moves(from, occupiedBB) & destBB);
+    case ROOK:
+        return (Attacks::rook_moves(from, occupiedBB) & destBB);
+    case QUEEN:
+        return (Attacks::queen_moves(from, occupiedBB) & destBB);
+    case KING:
+        return (Attacks::king_moves(from) & destBB);
+    default:
+        return false;
+    }
+}
+
+//=================================================================
+//! \brief  Détermine si un coup pseudo-légal est légal
+//!
+//! On calcule l'occupation après le coup, et on regarde si une
+//! pièce adverse (autre que celle prise) attaque alors notre roi.
+//! Ceci traite à la fois les clouages et les échecs,
+//! sans générer la liste des coups.
+//-----------------------------------------------------------------
+template <Color C>
+[[nodiscard]] bool Board::is_legal(const MOVE move) const noexcept
+{
+    constexpr Color Them = ~C;
+
+    const int from = Move::from(move);
+    const int dest = Move::dest(move);
+
+    //-------------------------------------------------- roque
+    // le roi ne doit pas être en échec, ni traverser une case attaquée
+    if (Move::is_castling(move))
+    {
+        if (square_attacked<Them>(from))
+            return false;
+
+        Bitboard king_path = squares_between(from, dest) | BB::sq2BB(dest);
+        while (king_path)
+        {
+            if (square_attacked<Them>(BB::pop_lsb(king_path)))
+                return false;
+        }
+        return true;
+    }
+
+    const Bitboard destBB = BB::sq2BB(dest);
+    Bitboard occupiedBB   = (occupancy_all() ^ BB::sq2BB(from)) | destBB;
+    Bitboard enemyBB      = colorPiecesBB[Them] & ~destBB;
+
+    // la prise en passant enlève un pion qui n'est pas sur la case d'arrivée
+    if (Move::is_enpassant(move))
+    {
+        const Bitboard capturedBB = BB::sq2BB(dest - PUSH[C]);
+        occupiedBB ^= capturedBB;
+        enemyBB    ^= capturedBB;
+    }
+
+    const int K = (Move::piece(move) == KING) ? dest : king_square<C>();
+
+    return !(  (Attacks::pawn_attacks<C>(K)       & enemyBB & typePiecesBB[PAWN])
+             | (Attacks::knight_moves(K)          & enemyBB & typePiecesBB[KNIGHT])
+             | (Attacks::king_moves(K)            & enemyBB & typePiecesBB[KING])
+             | (Attacks::bishop_moves(K, occupiedBB) & enemyBB & (typePiecesBB[BISHOP] | typePiecesBB[QUEEN]))
+             | (Attacks::rook_moves(K, occupiedBB)   & enemyBB & (typePiecesBB[ROOK]   | typePiecesBB[QUEEN])) );
+}
+
+// Explicit instantiations.
+template bool Board::is_pseudo_legal<WHITE>(const MOVE move) const noexcept;
+template bool Board::is_pseudo_legal<BLACK>(const MOVE move) const noexcept;
+
+template bool Board::is_legal<WHITE>(const MOVE move) const noexcept;
+template bool Board::is_legal<BLACK>(const MOVE move) const noexcept;
@@ -3,11 +3,16 @@
 #include "ThreadPool.h"
 #include "PolyBook.h"
 #include "Attacks.h"
+#include "Material.h"
+#include "NNUE.h"
 
 // Globals
 TranspositionTable  transpositionTable(HASH_SIZE);
 PolyBook            ownBook;
 ThreadPool          threadPool(1, false, true);
+#if defined USE_NNUE
+NNUE                nnue;
+#endif
 
 #if defined USE_TUNER
 #include "Tuner.h"
@@ -20,6 +25,10 @@ int main(int argCount, char* argValue[])
 {
     init_bitmasks();
     Attacks::init_masks();
+    Bitbase::init();
+#if defined USE_NNUE
+    nnue.load_embedded();
+#endif
 
 #if defined USE_TUNER
     ownTuner.runTexelTuning();
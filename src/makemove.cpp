@@ -1,6 +1,8 @@
 #include "Board.h"
 #include "Square.h"
 #include "Move.h"
+#include "TranspositionTable.h"
+#include "NNUE.h"
 
 /* This is the castle_mask array. We can use it to determine
 the castling permissions after a move. What we do is
@@ -56,7 +58,12 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
     assert(pieceOn[from] == piece);
 
     // Sauvegarde des caractéristiques de la position
-    game_history[gamemove_counter] = UndoInfo{hash, pawn_hash, move, ep_square, halfmove_counter, castling} ;
+    game_history[gamemove_counter] = UndoInfo{hash, pawn_hash, move, ep_square, halfmove_counter, castling, psqt, mat_key} ;
+
+#if defined USE_NNUE
+    if (accumulators != nullptr)
+        accumulators->push(move, C);
+#endif
 
 // La prise en passant n'est valable que tout de suite
 // Il faut donc la supprimer
@@ -109,6 +116,8 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
             pieceOn[from] = NO_TYPE;
             pieceOn[dest] = piece;
 
+            psqt += psqt_value(C, piece, dest) - psqt_value(C, piece, from);
+
 #if defined USE_HASH
             hash ^= piece_key[C][piece][from] ^ piece_key[C][piece][dest];
 #endif
@@ -150,6 +159,9 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
                 pieceOn[from] = NO_TYPE;
                 pieceOn[dest] = promo;
 
+                psqt    += psqt_value(C, promo, dest) - psqt_value(C, PAWN, from) - psqt_value(Them, captured, dest);
+                mat_key += material_unit(C, promo) - material_unit(C, PAWN) - material_unit(Them, captured);
+
 #if defined USE_HASH
                 hash ^= piece_key[C][piece][from];
                 hash ^= piece_key[C][promo][dest];
@@ -192,6 +204,9 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
                 BB::toggle_bit(colorPiecesBB[Them], dest);
                 BB::toggle_bit(typePiecesBB[captured], dest);
 
+                psqt    += psqt_value(C, piece, dest) - psqt_value(C, piece, from) - psqt_value(Them, captured, dest);
+                mat_key -= material_unit(Them, captured);
+
                 halfmove_counter = 0;
 
 #if defined USE_HASH
@@ -220,6 +235,9 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
             pieceOn[from] = NO_TYPE;
             pieceOn[dest] = promo;
 
+            psqt    += psqt_value(C, promo, dest) - psqt_value(C, PAWN, from);
+            mat_key += material_unit(C, promo) - material_unit(C, PAWN);
+
 #if defined USE_HASH
             hash ^= piece_key[C][piece][from];
             hash ^= piece_key[C][promo][dest];
@@ -257,6 +275,8 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
             pieceOn[from] = NO_TYPE;
             pieceOn[dest] = piece;
 
+            psqt += psqt_value(C, PAWN, dest) - psqt_value(C, PAWN, from);
+
 #if defined USE_HASH
             hash      ^= piece_key[C][PAWN][from] ^ piece_key[C][PAWN][dest];
             pawn_hash ^= piece_key[C][PAWN][from] ^ piece_key[C][PAWN][dest];
@@ -287,6 +307,9 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
             pieceOn[from] = NO_TYPE;
             pieceOn[dest] = PAWN;
 
+            psqt    += psqt_value(C, PAWN, dest) - psqt_value(C, PAWN, from);
+            mat_key -= material_unit(Them, PAWN);
+
 #if defined USE_HASH
             hash      ^= piece_key[C][PAWN][from] ^ piece_key[C][PAWN][dest];
             pawn_hash ^= piece_key[C][PAWN][from] ^ piece_key[C][PAWN][dest];
@@ -307,6 +330,7 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
                 BB::toggle_bit(typePiecesBB[PAWN], SQ::south(dest));
                 BB::toggle_bit(colorPiecesBB[Color::BLACK],   SQ::south(dest));
                 pieceOn[SQ::south(dest)] = NO_TYPE;
+                psqt -= psqt_value(Them, PAWN, SQ::south(dest));
 
 #if defined USE_HASH
                 hash      ^= piece_key[Them][PAWN][SQ::south(dest)];
@@ -318,6 +342,7 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
                 BB::toggle_bit(typePiecesBB[PAWN], SQ::north(dest));
                 BB::toggle_bit(colorPiecesBB[Color::WHITE],   SQ::north(dest));
                 pieceOn[SQ::north(dest)] = NO_TYPE;
+                psqt -= psqt_value(Them, PAWN, SQ::north(dest));
 
 #if defined USE_HASH
                 hash      ^= piece_key[Them][PAWN][SQ::north(dest)];
@@ -367,6 +392,9 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
                 pieceOn[ksc_castle_rook_from[C]] = NO_TYPE;
                 pieceOn[ksc_castle_rook_to[C]]   = ROOK;
 
+                psqt += psqt_value(C, KING, dest) - psqt_value(C, KING, from)
+                      + psqt_value(C, ROOK, ksc_castle_rook_to[C]) - psqt_value(C, ROOK, ksc_castle_rook_from[C]);
+
                 // Check if rook is at destination
                 assert(pieceOn[ksc_castle_rook_to[C]] == ROOK);
                 // Check that king is on its destination square
@@ -407,6 +435,9 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
                 pieceOn[qsc_castle_rook_from[C]] = NO_TYPE;
                 pieceOn[qsc_castle_rook_to[C]]   = ROOK;
 
+                psqt += psqt_value(C, KING, dest) - psqt_value(C, KING, from)
+                      + psqt_value(C, ROOK, qsc_castle_rook_to[C]) - psqt_value(C, ROOK, qsc_castle_rook_from[C]);
+
                 // Check if rook is at destination
                 assert(piece_on(qsc_castle_rook_to[C]) == ROOK);
                 // Check that king is on its destination square
@@ -423,6 +454,10 @@ template <Color C> constexpr void Board::make_move(const MOVE move) noexcept
 #if defined USE_HASH
     hash ^= side_key;
 
+    // La nouvelle clef est connue : on charge le cluster
+    // pendant que la recherche génère les coups
+    transpositionTable.prefetch(hash);
+
 #if defined DEBUG_HASH
     U64 hash_1, hash_2;
         calculate_hash(hash_1, hash_2);
@@ -455,7 +490,12 @@ template <Color C> constexpr void Board::make_nullmove() noexcept
 {
     // Sauvegarde des caractéristiques de la position
     // NullMove = 0
-    game_history[gamemove_counter] = UndoInfo{hash, pawn_hash, Move::MOVE_NULL, ep_square, halfmove_counter, castling};
+    game_history[gamemove_counter] = UndoInfo{hash, pawn_hash, Move::MOVE_NULL, ep_square, halfmove_counter, castling, psqt, mat_key};
+
+#if defined USE_NNUE
+    if (accumulators != nullptr)
+        accumulators->push(Move::MOVE_NULL, C);
+#endif
 
 // La prise en passant n'est valable que tout de suite
 // Il faut donc la supprimer
@@ -481,6 +521,7 @@ template <Color C> constexpr void Board::make_nullmove() noexcept
 
 #if defined USE_HASH
     hash ^= side_key;
+    transpositionTable.prefetch(hash);
 #endif
 
 #ifndef NDEBUG
@@ -1,7 +1,11 @@
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <vector>
 #include "Board.h"
 #include "defines.h"
 #include "Move.h"
+#include "PerftTable.h"
 
 template <Color C>
 [[nodiscard]] std::uint64_t Board::perft(const int depth) noexcept
@@ -78,9 +82,95 @@ template <Color C> [[nodiscard]] std::uint64_t Board::divide(const int depth) no
     return nodes;
 }
 
+//=================================================================
+//! \brief  Perft avec table de hachage
+//!
+//! Le nombre de noeuds d'une position ne dépend que de la position
+//! et de la profondeur : on le conserve dans la table, indexée par
+//! la clef Zobrist et la profondeur.
+//-----------------------------------------------------------------
+template <Color C>
+[[nodiscard]] std::uint64_t Board::perft_hash(const int depth, PerftTable& table) noexcept
+{
+    if (depth == 0)
+        return 1;
+
+    U64 total;
+    if (depth > 1 && table.probe(hash, depth, total))
+        return total;
+
+    MoveList ml;
+    legal_moves<C>(ml);
+
+    // bulk-counting
+    if (depth == 1)
+        return ml.count;
+
+    total = 0;
+    for (size_t index = 0; index < ml.count; index++)
+    {
+        make_move<C>(ml.moves[index]);
+        total += perft_hash<~C>(depth-1, table);
+        undo_move<C>();
+    }
+
+    table.store(hash, depth, total);
+    return total;
+}
+
+//=================================================================
+//! \brief  Perft multi-threads
+//!
+//! Les coups de la racine sont distribués aux threads au fur et
+//! à mesure ; chaque thread travaille sur sa propre copie de
+//! l'échiquier, et toutes partagent la même table de hachage.
+//-----------------------------------------------------------------
+template <Color C>
+[[nodiscard]] std::uint64_t Board::perft_threads(const int depth, const int nbr_threads, PerftTable& table) const
+{
+    Board    root(*this);
+    MoveList ml;
+    root.legal_moves<C>(ml);
+
+    if (depth <= 1)
+        return (depth == 0) ? 1 : ml.count;
+
+    std::atomic<size_t> next{0};
+    std::atomic<U64>    total{0};
+
+    auto worker = [&]() {
+        Board  board(*this);
+        U64    nodes = 0;
+        size_t index;
+
+        while ((index = next.fetch_add(1)) < ml.count)
+        {
+            board.make_move<C>(ml.moves[index]);
+            nodes += board.perft_hash<~C>(depth-1, table);
+            board.undo_move<C>();
+        }
+        total += nodes;
+    };
+
+    // la thread courante participe aussi
+    std::vector<std::thread> threads;
+    for (int i = 1; i < nbr_threads; i++)
+        threads.emplace_back(worker);
+    worker();
+
+    for (auto& t : threads)
+        t.join();
+
+    return total;
+}
+
 // Explicit instantiations.
 template std::uint64_t Board::perft<WHITE>(const int depth) noexcept;
 template std::uint64_t Board::perft<BLACK>(const int depth) noexcept;
 template std::uint64_t Board::divide<WHITE>(const int depth) noexcept;
 template std::uint64_t Board::divide<BLACK>(const int depth) noexcept;
+template std::uint64_t Board::perft_hash<WHITE>(const int depth, PerftTable& table) noexcept;
+template std::uint64_t Board::perft_hash<BLACK>(const int depth, PerftTable& table) noexcept;
+template std::uint64_t Board::perft_threads<WHITE>(const int depth, const int nbr_threads, PerftTable& table) const;
+template std::uint64_t Board::perft_threads<BLACK>(const int depth, const int nbr_threads, PerftTable& table) const;
 
@@ -1,22 +1,28 @@
 #include "Search.h"
 #include "MovePicker.h"
 #include "Move.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
 
 //=============================================================
 //! \brief  Recherche jusqu'à obtenir une position calme,
 //!         donc sans prise ou promotion.
+//! \param  depth   0 au premier niveau, puis négative
+//!
+//! Les entrées de la table sont stockées avec la profondeur 0
+//! si les échecs tranquilles ont été cherchés, -1 sinon.
 //-------------------------------------------------------------
 template <Color C>
-int Search::quiescence(int ply, int alpha, int beta, ThreadData* td)
+int Search::quiescence(int ply, int alpha, int beta, int depth, ThreadData* td)
 {
     assert(beta > alpha);
     
     OrderInfo* order = &td->order;
 
     //  Time-out
-    if (td->stopped || check_limits(td))
+    if (threadPool.is_stopped() || check_limits(td))
     {
-        td->stopped = true;
+        threadPool.signal_stop();
         return 0;
     }
 
@@ -46,24 +52,37 @@ int Search::quiescence(int ply, int alpha, int beta, ThreadData* td)
 
 
     // Est-ce que la table de transposition est utilisable ?
-   // int tt_score;
-   // int tt_eval;
-   // MOVE  tt_move  = Move::MOVE_NONE;
-   // int   tt_flag;
-   // int   tt_depth;
-   // bool  tt_hit   = transpositionTable.probe(board.hash, ply, tt_move, tt_score, tt_eval, tt_flag, tt_depth);
-
-   // // note : on ne teste pas la profondeur, car dasn la Quiescence, elle est à 0
-   // if (tt_hit)
-   // {
-   //     if (   (tt_flag & BOUND_EXACT)
-   //         || (tt_flag & BOUND_LOWER && tt_score >= beta)
-   //         || (tt_flag & BOUND_UPPER && tt_score <= alpha))
-   //         return tt_score;
-   // }
-
+    int   tt_score;
+    int   tt_eval;
+    MOVE  tt_move  = Move::MOVE_NONE;
+    int   tt_flag  = 0;
+    int   tt_depth = 0;
+    bool  tt_hit   = transpositionTable.probe(board.hash, ply, tt_move, tt_score, tt_eval, tt_flag, tt_depth);
+
+    // Profondeur de ce noeud pour la table : au premier niveau,
+    // les échecs tranquilles sont cherchés (0), ailleurs les prises seules (-1).
+    // Une entrée "prises seules" ne peut donc pas couper le premier niveau.
+#if defined USE_QUIESCENCE_CHECKS
+    const int qs_depth = (depth == 0 && !in_check) ? 0 : -1;
+#else
+    const int qs_depth = -1;
+#endif
+    const bool tt_usable = tt_hit && tt_depth >= qs_depth;
+
+    if (tt_usable)
+    {
+        if (   (tt_flag == BOUND_EXACT)
+            || (tt_flag == BOUND_LOWER && tt_score >= beta)
+            || (tt_flag == BOUND_UPPER && tt_score <= alpha))
+            return tt_score;
+    }
 
+    // On n'écrase pas une entrée plus profonde
+    // (recherche principale, ou premier niveau de la Quiescence)
+    const bool tt_store  = !tt_hit || tt_depth <= qs_depth;
+    const int  old_alpha = alpha;
     int  best_score;
+    int  static_eval = NOSCORE;
     int  score;
 
     // stand pat
@@ -71,12 +90,25 @@ int Search::quiescence(int ply, int alpha, int beta, ThreadData* td)
     if (!in_check)
     {
         // you do not allow the side to move to stand pat if the side to move is in check.
-        best_score = board.evaluate();
+        // L'évaluation statique est conservée dans la table
+        static_eval = (tt_hit && tt_eval != NOSCORE) ? tt_eval : board.evaluate();
+        best_score  = static_eval;
+
+        // Le score de la table est plus précis que l'évaluation,
+        // s'il la borne dans le bon sens
+        if (    tt_usable
+            && (   (tt_flag == BOUND_LOWER && tt_score > best_score)
+                || (tt_flag == BOUND_UPPER && tt_score < best_score)))
+            best_score = tt_score;
 
         // le score est trop mauvais pour moi, on n'a pas besoin
         // de chercher plus loin
         if (best_score >= beta)
+        {
+            if (tt_store)
+                transpositionTable.store(board.hash, Move::MOVE_NONE, best_score, static_eval, BOUND_LOWER, qs_depth, ply);
             return best_score;
+        }
 
         // l'évaluation est meilleure que alpha. Donc on peut améliorer
         // notre position. On continue à chercher.
@@ -88,10 +120,17 @@ int Search::quiescence(int ply, int alpha, int beta, ThreadData* td)
         best_score = -MATE + ply; // idée de Koivisto
     }
     
+    // Le coup de la table n'est joué que s'il est tactique
+    if (tt_move != Move::MOVE_NONE && !Move::is_tactical(tt_move))
+        tt_move = Move::MOVE_NONE;
+
     MOVE move;
-    MovePicker movePicker(&board, order, Move::MOVE_NONE,
+    MOVE best_move = Move::MOVE_NONE;
+    // En échec, on cherche toutes les parades, sinon le score de mat serait faux
+    MovePicker movePicker(&board, order, tt_move,
                           Move::MOVE_NONE, Move::MOVE_NONE, Move::MOVE_NONE,
-                          true, 0);
+                          Move::MOVE_NONE, Move::MOVE_NONE,
+                          !in_check, 0);
 
     // Boucle sur tous les coups
     while ((move = movePicker.next_move()) != Move::MOVE_NONE)
@@ -102,10 +141,10 @@ int Search::quiescence(int ply, int alpha, int beta, ThreadData* td)
 
         board.make_move<C>(move);
         td->move[ply] = move;
-        score = -quiescence<~C>(ply+1, -beta, -alpha, td);
+        score = -quiescence<~C>(ply+1, -beta, -alpha, depth-1, td);
         board.undo_move<C>();
 
-        if (td->stopped)
+        if (threadPool.is_stopped())
             return 0;
 
         // try for an early cutoff:
@@ -117,6 +156,8 @@ int Search::quiescence(int ply, int alpha, int beta, ThreadData* td)
             //     si->update_killers(ply, move);
             //     si->update_counter(C, ply, move);
             // }
+            if (tt_store)
+                transpositionTable.store(board.hash, move, score, static_eval, BOUND_LOWER, qs_depth, ply);
             return score;
         }
 
@@ -124,6 +165,7 @@ int Search::quiescence(int ply, int alpha, int beta, ThreadData* td)
         if (score > best_score)
         {
             best_score = score;
+            best_move  = move;
 
             // If score beats alpha we update alpha
             if (score > alpha)
@@ -131,8 +173,56 @@ int Search::quiescence(int ply, int alpha, int beta, ThreadData* td)
         }
     }
 
+#if defined USE_QUIESCENCE_CHECKS
+    // Au premier niveau, on cherche aussi les coups tranquilles
+    // donnant échec, sans perte de matériel : ceci permet de voir
+    // les mats et les attaques doubles juste après l'horizon.
+    if (!in_check && depth == 0)
+    {
+        MoveList ml;
+        board.legal_quiet_checks<C>(ml);
+
+        for (size_t i = 0; i < ml.count; i++)
+        {
+            move = ml.moves[i];
+            if (!board.fast_see(move, 0))
+                continue;
+
+            board.make_move<C>(move);
+            td->move[ply] = move;
+            score = -quiescence<~C>(ply+1, -beta, -alpha, depth-1, td);
+            board.undo_move<C>();
+
+            if (threadPool.is_stopped())
+                return 0;
+
+            if (score >= beta)
+            {
+                if (tt_store)
+                    transpositionTable.store(board.hash, move, score, static_eval, BOUND_LOWER, qs_depth, ply);
+                return score;
+            }
+
+            if (score > best_score)
+            {
+                best_score = score;
+                best_move  = move;
+
+                if (score > alpha)
+                    alpha = score;
+            }
+        }
+    }
+#endif
+
+    if (tt_store)
+    {
+        int flag = (alpha != old_alpha) ? BOUND_EXACT : BOUND_UPPER;
+        transpositionTable.store(board.hash, best_move, best_score, static_eval, flag, qs_depth, ply);
+    }
+
     return best_score;
 }
 
-template int Search::quiescence<WHITE>(int ply, int alpha, int beta, ThreadData* td);
-template int Search::quiescence<BLACK>(int ply, int alpha, int beta, ThreadData* td);
+template int Search::quiescence<WHITE>(int ply, int alpha, int beta, int depth, ThreadData* td);
+template int Search::quiescence<BLACK>(int ply, int alpha, int beta, int depth, ThreadData* td);
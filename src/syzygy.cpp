@@ -140,6 +140,53 @@ bool Board::probe_root(MOVE& move) const
     return true;
 }
 
+//=========================================================================
+//! \brief Classement des coups de la racine par les tables Syzygy.
+//! Chaque coup reçoit le résultat (WDL) de la position obtenue.
+//! This function should not be used during search.
+//! \return false si la position n'est pas dans les tables
+//-------------------------------------------------------------------------
+bool Board::probe_root_ranks(std::vector<RootMove>& root_moves) const
+{
+    if (castling || BB::count_bit(occupancy_all()) > TB_LARGEST)
+        return false;
+
+    unsigned results[TB_MAX_MOVES];
+
+    unsigned result = tb_probe_root(
+        occupancy_c<WHITE>(),  occupancy_c<BLACK>(),
+        occupancy_p<KING>(),   occupancy_p<QUEEN>(),
+        occupancy_p<ROOK>(),   occupancy_p<BISHOP>(),
+        occupancy_p<KNIGHT>(), occupancy_p<PAWN>(),
+        halfmove_counter,
+        ep_square == NO_SQUARE ? 0 : ep_square,
+        turn() == WHITE ? 1 : 0,
+        results);
+
+    if (   result == TB_RESULT_FAILED
+        || result == TB_RESULT_CHECKMATE
+        || result == TB_RESULT_STALEMATE)
+        return false;
+
+    // Les coups de Pyrrhic ne contiennent ni la pièce, ni les drapeaux :
+    // on ne compare que les cases et la promotion
+    constexpr U32 mask = Move::MOVE_FROM | Move::MOVE_DEST | Move::MOVE_PROMO;
+
+    for (int i = 0; i < TB_MAX_MOVES && results[i] != TB_RESULT_FAILED; i++)
+    {
+        MOVE move = convertPyrrhicMove(results[i]);
+        int  rank = static_cast<int>(TB_GET_WDL(results[i])) - TB_DRAW;
+
+        for (RootMove& rm : root_moves)
+        {
+            if ((rm.move & mask) == (move & mask))
+                rm.tb_rank = rank;
+        }
+    }
+
+    return true;
+}
+
 MOVE Board::convertPyrrhicMove(unsigned result) const
 {
     // Extract Pyrhic's move representation
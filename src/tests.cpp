@@ -3,10 +3,25 @@
 #include <iostream>
 #include <chrono>
 #include <iomanip>      // std::setw
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
 
 #include "defines.h"
 #include "Board.h"
 #include "Move.h"
+#include "TranspositionTable.h"
+#include "PerftTable.h"
+#include "PawnCache.h"
+#include "Material.h"
+#include "NNUE.h"
+#include "ThreadPool.h"
 
 
 void sort_moves(MoveList& ml);
@@ -15,6 +30,8 @@ void sort_moves(MoveList& ml);
 //! \brief Réalisation d'une série de tests "perft"
 //!
 //! On va faire, pour chaque position, plusieurs tests
+//! Le perft est multi-threads (option Threads), avec
+//! une table de hachage commune à toute la suite.
 //!
 //! \param[in]  dmax    profondeur max
 //----------------------------------------------------
@@ -59,6 +76,10 @@ void test_suite(const std::string& abc, int dmax)
     char            tag2 = ' ';
 
     Board *CB = new Board();
+    const int  nbr_threads = threadPool.get_nbrThreads();
+    PerftTable table;
+    table.init_size(PERFT_HASH_SIZE);
+
     auto start = std::chrono::high_resolution_clock::now();
 
     // Boucle sur l'ensemble des positions de test
@@ -103,6 +124,8 @@ void test_suite(const std::string& abc, int dmax)
 //#if 0
         // nombre de profondeurs possibles
         int nbr_prof = liste1.size() - 1;
+        U64 position_nodes = 0;
+        auto position_start = std::chrono::high_resolution_clock::now();
 
         // boucle sur les profondeurs de test
         for (int i=1; i<=nbr_prof; i++)
@@ -133,12 +156,13 @@ void test_suite(const std::string& abc, int dmax)
 
                 // Exécution du test perft pour cette position et cette profondeur
                 if (CB->turn() == WHITE)
-                    actual = CB->perft<WHITE>(depth);
+                    actual = CB->perft_threads<WHITE>(depth, nbr_threads, table);
                 else
-                    actual = CB->perft<BLACK>(depth);
+                    actual = CB->perft_threads<BLACK>(depth, nbr_threads, table);
 
                 total_expected += expected;
                 total_actual   += actual;
+                position_nodes += actual;
                 total_tests++;
 
                 if (expected == actual)
@@ -156,6 +180,15 @@ void test_suite(const std::string& abc, int dmax)
                 }
             }
         } // boucle depth
+
+        auto position_end = std::chrono::high_resolution_clock::now();
+        auto position_us  = std::chrono::duration_cast<std::chrono::microseconds>(position_end - position_start).count();
+        if (position_nodes > 0)
+            std::cout << "ligne=" << std::setw(4) << numero
+                      << " ; noeuds=" << std::setw(12) << position_nodes
+                      << " ; Mnps=" << std::fixed << std::setprecision(1) << std::setw(8)
+                      << (position_us > 0 ? static_cast<double>(position_nodes) / static_cast<double>(position_us) : 0.0)
+                      << std::endl;
 //#endif
     } // boucle position
 
@@ -170,6 +203,7 @@ void test_suite(const std::string& abc, int dmax)
     std::cout << "# Total        " << std::setw(10) << total_tests << std::endl;
     std::cout << "Moves Actual   " << std::setw(10) << total_actual << std::endl;
     std::cout << "Moves Expected " << std::setw(10) << total_expected << std::endl;
+    std::cout << "Threads        " << std::setw(10) << nbr_threads << std::endl;
     std::cout << "Time           " << std::setw(9)  << sec << std::endl;
     if (sec > 0)
         std::cout << "Million Moves/s        " << std::setw(9) << static_cast<double>(total_actual)/static_cast<double>(sec)/1000000.0 << std::endl;
@@ -179,6 +213,157 @@ void test_suite(const std::string& abc, int dmax)
     delete CB;
 }
 
+//========================================================
+//! \brief  Réserve de coups venant d'autres positions,
+//! utilisée pour éprouver is_pseudo_legal / is_legal
+//---------------------------------------------------------
+struct LegalPool
+{
+    std::array<MOVE, 1024> moves{};
+    size_t count = 0;
+    U64    tested = 0;
+    U64    errors = 0;
+
+    void push(const MOVE move) { moves[count++ % moves.size()] = move; }
+    size_t size() const { return std::min(count, moves.size()); }
+};
+
+//========================================================
+//! \brief  Compare is_pseudo_legal/is_legal à la génération
+//! complète, sur tous les noeuds d'un arbre perft
+//---------------------------------------------------------
+template <Color C>
+static void check_legal(Board& board, const int depth, LegalPool& pool)
+{
+    MoveList ml;
+    board.legal_moves<C>(ml);
+
+    auto in_list = [&ml](const MOVE move) {
+        for (size_t i = 0; i < ml.count; i++)
+            if (ml.moves[i] == move)
+                return true;
+        return false;
+    };
+
+    // les coups générés doivent tous être acceptés,
+    // ceux des autres positions uniquement s'ils sont dans la liste
+    for (size_t i = 0; i < ml.count; i++)
+    {
+        pool.tested++;
+        if (!board.is_pseudo_legal<C>(ml.moves[i]) || !board.is_legal<C>(ml.moves[i]))
+        {
+            pool.errors++;
+            std::cout << "refuse  : " << Move::name(ml.moves[i]) << " ; " << board.get_fen() << std::endl;
+        }
+    }
+    for (size_t i = 0; i < pool.size(); i++)
+    {
+        const MOVE move = pool.moves[i];
+        pool.tested++;
+        if ((board.is_pseudo_legal<C>(move) && board.is_legal<C>(move)) != in_list(move))
+        {
+            pool.errors++;
+            std::cout << "erreur  : " << Move::name(move) << " ; " << board.get_fen() << std::endl;
+        }
+    }
+
+    // les échecs tranquilles doivent être exactement les coups
+    // tranquilles (hors roque) mettant le roi adverse en échec
+    if (!board.is_in_check<C>())
+    {
+        MoveList checks;
+        board.legal_quiet_checks<C>(checks);
+
+        size_t expected = 0;
+        for (size_t i = 0; i < ml.count; i++)
+        {
+            const MOVE move = ml.moves[i];
+            if (Move::is_tactical(move) || Move::is_castling(move))
+                continue;
+
+            board.make_move<C>(move);
+            const bool check = board.is_in_check<~C>();
+            board.undo_move<C>();
+            if (!check)
+                continue;
+
+            expected++;
+            bool found = false;
+            for (size_t j = 0; j < checks.count; j++)
+                found |= (checks.moves[j] == move);
+            if (!found)
+            {
+                pool.errors++;
+                std::cout << "echec   : " << Move::name(move) << " ; " << board.get_fen() << std::endl;
+            }
+        }
+        pool.tested += checks.count;
+        if (checks.count != expected)
+        {
+            pool.errors++;
+            std::cout << "echecs  : " << checks.count << " / " << expected << " ; " << board.get_fen() << std::endl;
+        }
+    }
+
+    for (size_t i = 0; i < ml.count; i++)
+        pool.push(ml.moves[i]);
+
+    if (depth <= 1)
+        return;
+
+    for (size_t i = 0; i < ml.count; i++)
+    {
+        board.make_move<C>(ml.moves[i]);
+        check_legal<~C>(board, depth - 1, pool);
+        board.undo_move<C>();
+    }
+}
+
+//========================================================
+//! \brief  Contrôle de la validation rapide des coups
+//! (table, killers, counter) sur la suite perft
+//! \param  dmax    profondeur max
+//---------------------------------------------------------
+void test_legal(const std::string& abc, int dmax)
+{
+    std::string     str_file = Home + "tests/perftsuite_" + abc + ".epd";
+    std::ifstream file(str_file);
+    if (!file.is_open())
+    {
+        std::cout << "[test_legal] impossible d'ouvrir le fichier " << str_file << std::endl;
+        return;
+    }
+
+    std::string line;
+    LegalPool   pool;
+    Board       board;
+    int         positions = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    while (std::getline(file, line))
+    {
+        if (line.size() < 3 || line[0] == '/' || line[0] == ' ')
+            continue;
+
+        board.set_fen(split(line, ';').at(0), false);
+        positions++;
+
+        if (board.turn() == WHITE)
+            check_legal<WHITE>(board, dmax, pool);
+        else
+            check_legal<BLACK>(board, dmax, pool);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto sec = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()/1000.0;
+
+    std::cout << "# Positions    " << std::setw(10) << positions   << std::endl;
+    std::cout << "# Coups testes " << std::setw(10) << pool.tested << std::endl;
+    std::cout << "# Erreurs      " << std::setw(10) << pool.errors << std::endl;
+    std::cout << "Time           " << std::setw(9)  << sec         << std::endl;
+}
+
 //========================================================
 //! \brief  lancement d'un test perft sur une position
 //! \param  depth   profondeur max de recherche
@@ -241,15 +426,18 @@ void test_perft(const std::string& str, int depth)
 
     //    CB.test_rays();
 
+    const int  nbr_threads = threadPool.get_nbrThreads();
+    PerftTable table;
+    table.init_size(PERFT_HASH_SIZE);
 
     auto start      = std::chrono::high_resolution_clock::now();
     auto start_time = std::chrono::steady_clock::now();
     U64 total;
 
     if (CB.turn() == WHITE)
-        total = CB.perft<WHITE>(depth);
+        total = CB.perft_threads<WHITE>(depth, nbr_threads, table);
     else
-        total = CB.perft<BLACK>(depth);
+        total = CB.perft_threads<BLACK>(depth, nbr_threads, table);
 
     auto end        = std::chrono::high_resolution_clock::now();
     auto end_time   = std::chrono::steady_clock::now();
@@ -674,3 +862,539 @@ void test_see()
 
 }
 
+
+//========================================================
+//! \brief  Test de la table de transposition lockless
+//!
+//! Plusieurs threads écrivent et lisent en même temps dans
+//! une table dont on n'utilise que quelques clusters : toutes
+//! les clefs se disputent les mêmes entrées.
+//! Chaque écriture porte des données propres à la clef et au
+//! thread qui l'écrit (numéro codé dans le coup) : une entrée
+//! mélangeant les données de 2 écritures est donc détectée.
+//--------------------------------------------------------
+void test_tt()
+{
+    constexpr int NBR_THREADS  = 4;
+    constexpr int NBR_CLUSTERS = 4;       // clusters utilisés
+    constexpr int NBR_KEYS     = 1024;    // bien plus que d'entrées disponibles
+    constexpr int NBR_LOOPS    = 2000000;
+
+    auto tt = std::make_unique<TranspositionTable>(1);
+
+    std::atomic<U64> hits(0);
+    std::atomic<U64> errors(0);
+
+    // générateur xorshift64
+    auto next64 = [](U64& seed) {
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        return seed * 2685821657736338717ULL;
+    };
+
+    // Les clefs sont communes à tous les threads ; leurs bits
+    // de poids faible (index du cluster) sont limités
+    std::vector<U64> keys(NBR_KEYS);
+    U64 s = 0x123456789ABCDEFULL;
+    for (int i = 0; i < NBR_KEYS; i++)
+        keys[i] = (next64(s) & 0xFFFFFFFF00000000ULL) | (i % NBR_CLUSTERS);
+
+    // Données écrites par le thread "writer" pour la clef "hash"
+    struct Payload { MOVE move; Score score; Score eval; int depth; int flag; };
+    auto payload = [](U64 hash, int writer) {
+        U64 h = hash ^ (0x9E3779B97F4A7C15ULL * (writer + 1));
+        h ^= h >> 31;  h *= 0xBF58476D1CE4E5B9ULL;  h ^= h >> 29;
+
+        Payload p;
+        p.move  = (static_cast<MOVE>(h & 0xFFFFFF) << 4) | static_cast<MOVE>(writer + 1);
+        p.score = static_cast<int>((h >> 24) % 2000) - 1000;
+        p.eval  = static_cast<int>((h >> 36) % 2000) - 1000;
+        p.depth = static_cast<int>((h >> 48) % 64);
+        p.flag  = static_cast<int>((h >> 56) % 3);
+        return p;
+    };
+
+    auto worker = [&](int id)
+    {
+        U64 seed = 0x9E3779B97F4A7C15ULL * (id + 1);
+
+        MOVE  move;
+        Score score, eval;
+        int   flag, depth;
+        U64   nhits = 0, nerrors = 0;
+
+        for (int n = 0; n < NBR_LOOPS; n++)
+        {
+            U64 hash = keys[next64(seed) % NBR_KEYS];
+
+            if (n & 1)
+            {
+                Payload p = payload(hash, id);
+                tt->store(hash, p.move, p.score, p.eval, p.flag, p.depth, 0);
+            }
+            else if (tt->probe(hash, 0, move, score, eval, flag, depth))
+            {
+                nhits++;
+
+                // le thread qui a écrit l'entrée est retrouvé par le coup
+                int writer = static_cast<int>(move & 15) - 1;
+                if (writer < 0 || writer >= NBR_THREADS)
+                {
+                    nerrors++;
+                    continue;
+                }
+
+                Payload p = payload(hash, writer);
+                if (move != p.move || score != p.score || eval != p.eval || depth != p.depth || flag != p.flag)
+                    nerrors++;
+            }
+        }
+
+        hits   += nhits;
+        errors += nerrors;
+    };
+
+    std::cout << "test de la table de transposition : " << NBR_THREADS << " threads" << std::endl;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NBR_THREADS; i++)
+        threads.emplace_back(worker, i);
+    for (auto& t : threads)
+        t.join();
+
+    std::cout << "lectures réussies : " << hits
+              << " ; incohérences : " << errors
+              << (errors == 0 ? "  OK" : "  ECHEC") << std::endl;
+}
+
+#if defined USE_NNUE
+//========================================================
+//! \brief  Test des accumulateurs du réseau
+//!
+//! On joue des parties aléatoires, avec des coups nuls et des
+//! retours en arrière. De temps en temps, l'accumulateur obtenu
+//! par mise à jour incrémentale (AccumulatorStack::current) est
+//! comparé au calcul complet (NNUE::refresh).
+//! Si aucun réseau n'est chargé, on utilise un réseau aux poids
+//! aléatoires, écrit dans un fichier temporaire, puis déchargé.
+//--------------------------------------------------------
+void test_nnue()
+{
+    constexpr int NBR_GAMES  = 200;     // parties par position
+    constexpr int NBR_PLIES  = 100;     // reste dans la pile des accumulateurs
+
+    // positions riches en roques, prises en passant et promotions
+    static const std::string FENS[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1P/PPPBBPpP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p2/8/4P1P1/4k3 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+    };
+
+    U64 seed = 0x9E3779B97F4A7C15ULL;
+    auto rand64 = [&seed]() {
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        return seed * 2685821657736338717ULL;
+    };
+
+    const bool synthetic = !nnue.is_loaded();
+    if (synthetic)
+    {
+        constexpr std::size_t nbr = NNUE_INPUTS * NNUE_HIDDEN + NNUE_HIDDEN + 2 * NNUE_HIDDEN + 1;
+        std::vector<I16> values(nbr);
+        for (I16& v : values)
+            v = static_cast<I16>(static_cast<int>(rand64() % 129) - 64);
+
+        const std::string path = (std::filesystem::temp_directory_path() / "zangdar_test.nnue").string();
+
+        // un fichier trop grand n'est pas un réseau de cette architecture
+        {
+            std::ofstream file(path, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(I16));
+            file.write(std::string(128, '\0').data(), 128);
+        }
+        const bool big_loaded = nnue.load(path);
+
+        {
+            std::ofstream file(path, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(I16));
+        }
+        const bool loaded = !big_loaded && nnue.load(path);
+        std::remove(path.c_str());
+
+        if (!loaded)
+        {
+            nnue.unload();
+            std::cout << "test nnue : " << (big_loaded ? "fichier trop grand accepté" : "réseau aléatoire non chargé")
+                      << "  ECHEC" << std::endl;
+            return;
+        }
+        std::cout << "test nnue : réseau aux poids aléatoires" << std::endl;
+    }
+    else
+    {
+        std::cout << "test nnue : réseau chargé" << std::endl;
+    }
+
+    AccumulatorStack stack;
+    stack.init();
+
+    U64 checks = 0, errors = 0;
+    U64 castles = 0, enpassants = 0, promotions = 0, nulls = 0, undos = 0;
+
+    // compare l'accumulateur de la pile au calcul complet
+    auto check = [&](Board& board) {
+        Accumulator ref;
+        nnue.refresh(board, ref);
+        const Accumulator& acc = stack.current(board);
+        checks++;
+        if (std::memcmp(acc.values, ref.values, sizeof(ref.values)) != 0)
+        {
+            errors++;
+            if (errors <= 10)
+                std::cout << "accumulateur faux : " << board.get_fen() << std::endl;
+        }
+    };
+
+    for (const std::string& fen : FENS)
+    {
+        for (int game = 0; game < NBR_GAMES; game++)
+        {
+            Board board(fen);
+            stack.reset(board);
+            board.set_accumulators(&stack);
+
+            std::vector<MOVE> played;
+
+            for (int ply = 0; ply < NBR_PLIES; ply++)
+            {
+                const Color us = board.turn();
+
+                // retour en arrière
+                if (!played.empty() && rand64() % 8 == 0)
+                {
+                    const MOVE last = played.back();
+                    played.pop_back();
+                    if (last == Move::MOVE_NULL)
+                        (us == WHITE) ? board.undo_nullmove<BLACK>() : board.undo_nullmove<WHITE>();
+                    else
+                        (us == WHITE) ? board.undo_move<BLACK>() : board.undo_move<WHITE>();
+                    undos++;
+                    check(board);
+                    continue;
+                }
+
+                const bool in_check = (us == WHITE) ? board.is_in_check<WHITE>() : board.is_in_check<BLACK>();
+
+                MOVE move;
+                if (!in_check && rand64() % 16 == 0)
+                {
+                    move = Move::MOVE_NULL;
+                    (us == WHITE) ? board.make_nullmove<WHITE>() : board.make_nullmove<BLACK>();
+                    nulls++;
+                }
+                else
+                {
+                    MoveList ml;
+                    (us == WHITE) ? board.legal_moves<WHITE>(ml) : board.legal_moves<BLACK>(ml);
+                    if (ml.count == 0)
+                        break;
+
+                    // les coups spéciaux sont choisis en priorité
+                    move = ml.moves[rand64() % ml.count];
+                    for (size_t i = 0; i < ml.count; i++)
+                    {
+                        const MOVE m = ml.moves[i];
+                        if ((Move::is_castling(m) || Move::is_enpassant(m) || Move::is_promoting(m)) && rand64() % 2 == 0)
+                        {
+                            move = m;
+                            break;
+                        }
+                    }
+
+                    castles    += Move::is_castling(move);
+                    enpassants += Move::is_enpassant(move);
+                    promotions += Move::is_promoting(move);
+                    (us == WHITE) ? board.make_move<WHITE>(move) : board.make_move<BLACK>(move);
+                }
+                played.push_back(move);
+
+                // évaluation paresseuse : plusieurs coups peuvent
+                // être appliqués d'un seul coup
+                if (rand64() % 3 == 0)
+                    check(board);
+            }
+            check(board);
+        }
+    }
+
+    if (synthetic)
+        nnue.unload();
+
+    std::cout << "roques : " << castles << " ; en passant : " << enpassants
+              << " ; promotions : " << promotions << " ; coups nuls : " << nulls
+              << " ; retours : " << undos << std::endl;
+    std::cout << "comparaisons : " << checks
+              << " ; erreurs : " << errors
+              << (errors == 0 ? "  OK" : "  ECHEC") << std::endl;
+}
+#endif
+
+//====================================================
+//  Micro-benchmarks
+//  Positions intégrées à l'exécutable : les mesures ne
+//  dépendent ni du répertoire Home, ni des fichiers de test.
+//----------------------------------------------------
+static const std::string BENCH_POSITIONS[] = {
+    START_FEN,
+    KIWIPETE,
+    SILVER2,
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1",
+    "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 3 9",
+    "8/8/1p1k4/p1p2p2/P1P2P2/1P1K4/8/8 b - - 0 40",
+};
+
+static volatile U64 bench_sink = 0;     // empêche le compilateur de supprimer les calculs
+
+//====================================================
+//! \brief  Mesure d'une opération
+//!
+//! "pass" effectue une passe sur toutes les positions,
+//! et retourne le nombre d'opérations réalisées.
+//! Après un échauffement, on fait plusieurs mesures,
+//! et on affiche les statistiques en ns par opération.
+//----------------------------------------------------
+template <typename F>
+static void run_microbench(const std::string& name, F&& pass)
+{
+    using clock = std::chrono::steady_clock;
+    constexpr int NBR_MESURES = 15;
+
+    // échauffement : au moins 100 ms, ce qui donne aussi
+    // le nombre de passes pour une mesure d'environ 20 ms
+    int  passes = 0;
+    U64  ops    = 0;
+    auto start  = clock::now();
+    do
+    {
+        ops = pass();
+        passes++;
+    } while (clock::now() - start < std::chrono::milliseconds(100));
+
+    const int passes_per_mesure = std::max(1, passes / 5);
+
+    std::vector<double> samples;
+    for (int r = 0; r < NBR_MESURES; r++)
+    {
+        U64 nbr = 0;
+        auto t0 = clock::now();
+        for (int p = 0; p < passes_per_mesure; p++)
+            nbr += pass();
+        auto t1 = clock::now();
+
+        double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        samples.push_back(ns / static_cast<double>(std::max<U64>(nbr, 1)));
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double mean = 0;
+    for (double x : samples)
+        mean += x;
+    mean /= NBR_MESURES;
+    double var = 0;
+    for (double x : samples)
+        var += (x - mean) * (x - mean);
+    const double stddev = std::sqrt(var / NBR_MESURES);
+
+    std::cout << std::left  << std::setw(14) << name << std::right
+              << " ops/passe=" << std::setw(7) << ops
+              << std::fixed << std::setprecision(1)
+              << " ; min="     << std::setw(9) << samples.front()
+              << " ; mediane=" << std::setw(9) << samples[NBR_MESURES / 2]
+              << " ; moyenne=" << std::setw(9) << mean
+              << " +- "        << std::setw(6) << stddev
+              << " ns/op" << std::endl;
+}
+
+//====================================================
+//! \brief  Génération des coups
+//----------------------------------------------------
+template <Color C>
+static U64 bench_generate(Board& board, bool noisy)
+{
+    MoveList ml;
+    if (noisy)
+        board.legal_noisy<C>(ml);
+    else
+        board.legal_moves<C>(ml);
+    bench_sink = bench_sink + ml.count;
+    return 1;
+}
+
+//====================================================
+//! \brief  make_move + undo_move de tous les coups
+//----------------------------------------------------
+template <Color C>
+static U64 bench_make(Board& board, const MoveList& ml)
+{
+    for (size_t i = 0; i < ml.count; i++)
+    {
+        board.make_move<C>(ml.moves[i]);
+        board.undo_move<C>();
+    }
+    bench_sink = bench_sink + board.get_hash();
+    return ml.count;
+}
+
+//====================================================
+//! \brief  Lancement des micro-benchmarks
+//! \param  what    gen, noisy, make, eval, see ou all
+//----------------------------------------------------
+void test_microbench(const std::string& what)
+{
+    static const std::string NAMES[] = {"gen", "noisy", "make", "eval", "see", "all"};
+
+    if (std::find(std::begin(NAMES), std::end(NAMES), what) == std::end(NAMES))
+    {
+        std::cout << "bench : sous-commande inconnue \"" << what << "\"" << std::endl;
+        std::cout << "sous-commandes valides :";
+        for (const std::string& name : NAMES)
+            std::cout << " " << name;
+        std::cout << std::endl;
+        return;
+    }
+
+    std::vector<Board>    boards;
+    std::vector<MoveList> all_moves;       // coups légaux de chaque position
+    std::vector<MoveList> noisy_moves;     // captures et promotions
+
+    for (const std::string& fen : BENCH_POSITIONS)
+    {
+        boards.emplace_back(fen);
+        Board& board = boards.back();
+
+        MoveList ml, mn;
+        if (board.turn() == WHITE)
+        {
+            board.legal_moves<WHITE>(ml);
+            board.legal_noisy<WHITE>(mn);
+        }
+        else
+        {
+            board.legal_moves<BLACK>(ml);
+            board.legal_noisy<BLACK>(mn);
+        }
+        all_moves.push_back(ml);
+        noisy_moves.push_back(mn);
+    }
+
+    // Chaque position a ses propres caches, comme une thread
+    // de recherche (voir Search::think) : "evaluate" est ainsi
+    // mesurée dans les conditions de la recherche.
+    // Le vecteur "boards" ne doit plus être modifié.
+    std::vector<std::unique_ptr<PawnCache>>     pawn_caches;
+    std::vector<std::unique_ptr<MaterialCache>> material_caches;
+#if defined USE_NNUE
+    std::vector<std::unique_ptr<AccumulatorStack>> accumulators;
+#endif
+
+    for (Board& board : boards)
+    {
+        pawn_caches.push_back(std::make_unique<PawnCache>());
+        pawn_caches.back()->init_size(PAWN_HASH_SIZE);
+        board.set_pawn_cache(pawn_caches.back().get());
+
+        material_caches.push_back(std::make_unique<MaterialCache>());
+        material_caches.back()->init();
+        board.set_material_cache(material_caches.back().get());
+
+#if defined USE_NNUE
+        if (nnue.is_loaded())
+        {
+            accumulators.push_back(std::make_unique<AccumulatorStack>());
+            accumulators.back()->init();
+            accumulators.back()->reset(board);
+            board.set_accumulators(accumulators.back().get());
+        }
+#endif
+    }
+
+    const bool all = (what == "all");
+    std::cout << "micro-benchmarks : " << boards.size() << " positions" << std::endl;
+
+    if (all || what == "gen")
+    {
+        run_microbench("legal_moves", [&]() {
+            U64 n = 0;
+            for (Board& b : boards)
+                n += (b.turn() == WHITE) ? bench_generate<WHITE>(b, false) : bench_generate<BLACK>(b, false);
+            return n;
+        });
+    }
+
+    if (all || what == "noisy")
+    {
+        run_microbench("legal_noisy", [&]() {
+            U64 n = 0;
+            for (Board& b : boards)
+                n += (b.turn() == WHITE) ? bench_generate<WHITE>(b, true) : bench_generate<BLACK>(b, true);
+            return n;
+        });
+    }
+
+    if (all || what == "make")
+    {
+        run_microbench("make/undo", [&]() {
+            U64 n = 0;
+            for (size_t i = 0; i < boards.size(); i++)
+                n += (boards[i].turn() == WHITE) ? bench_make<WHITE>(boards[i], all_moves[i])
+                                                 : bench_make<BLACK>(boards[i], all_moves[i]);
+            return n;
+        });
+    }
+
+    if (all || what == "eval")
+    {
+        // Avec le réseau, l'accumulateur est à jour après le premier appel :
+        // sa mise à jour incrémentale (make_move) n'est pas mesurée
+        std::string name = "evaluate";
+#if defined USE_NNUE
+        if (nnue.is_loaded())
+            name += " (nnue, accumulateur à jour)";
+#endif
+
+        run_microbench(name, [&]() {
+            U64 n = 0;
+            for (Board& b : boards)
+            {
+                bench_sink = bench_sink + static_cast<U64>(b.evaluate());
+                n++;
+            }
+            return n;
+        });
+    }
+
+    if (all || what == "see")
+    {
+        run_microbench("fast_see", [&]() {
+            U64 n = 0;
+            for (size_t i = 0; i < boards.size(); i++)
+            {
+                const MoveList& ml = noisy_moves[i];
+                for (size_t j = 0; j < ml.count; j++)
+                    bench_sink = bench_sink + boards[i].fast_see(ml.moves[j], 0);
+                n += ml.count;
+            }
+            return n;
+        });
+    }
+}
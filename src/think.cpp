@@ -4,9 +4,36 @@
 #include "Timer.h"
 #include "TranspositionTable.h"
 #include "Move.h"
+#include <algorithm>
+#include <optional>
 
 #define CLAMP(x, low, high)  (((x) > (high)) ? (high) : (((x) < (low)) ? (low) : (x)))
 
+//======================================================
+//! \brief  Ordre des coups de la racine
+//! Classement Syzygy, puis score de l'itération, puis score
+//! de l'itération précédente ; le tri étant stable, les coups
+//! sans score gardent leur ordre.
+//------------------------------------------------------
+static bool root_move_order(const RootMove& a, const RootMove& b)
+{
+    if (a.tb_rank != b.tb_rank)
+        return a.tb_rank > b.tb_rank;
+    if (a.score != b.score)
+        return a.score > b.score;
+    return a.prev_score > b.prev_score;
+}
+
+//======================================================
+//! \brief  Coup suivant de la racine, dans l'ordre de la liste
+//! L'index part de pv_index : les coups des lignes MultiPV
+//! déjà trouvées, classés en tête de liste, sont ainsi sautés
+//------------------------------------------------------
+static inline MOVE next_root_move(ThreadData* td, int& index)
+{
+    return index < static_cast<int>(td->root_moves.size()) ? td->root_moves[index++].move : Move::MOVE_NONE;
+}
+
 
 //======================================================
 //! \brief  Lancement d'une recherche
@@ -24,16 +51,42 @@ void Search::think(const Board &m_board, const Timer &m_timer, int _index)
     printlog(message);
 #endif
 
+    ThreadData* td = &threadPool.threadData[_index];
+
     board = m_board;
     timer = m_timer;
+    td->root_moves = threadPool.get_root_moves();
+    board.set_pawn_cache(&td->pawn_cache);
+    board.set_material_cache(&td->material_cache);
+#if defined USE_NNUE
+    if (nnue.is_loaded())
+    {
+        td->accumulators.reset(board);
+        board.set_accumulators(&td->accumulators);
+    }
+    else
+    {
+        board.set_accumulators(nullptr);
+    }
+#endif
 
-    ThreadData* td = &threadPool.threadData[_index];
+    td->ponder_move = Move::MOVE_NONE;
 
     // iterative deepening
     iterative_deepening<C>(td);
 
     if (_index == 0)
     {
+        // En mode "ponder", on ne doit pas donner de coup
+        // avant "ponderhit" ou "stop" : seules ces commandes de la GUI
+        // remettent "pondering" à faux. Le signal d'arrêt peut aussi
+        // venir de la limite en noeuds, il ne suffit donc pas.
+        threadPool.wait_ponder_end();
+
+        // La variation principale peut être tronquée par la table
+        if (td->ponder_move == Move::MOVE_NONE && td->best_move != Move::MOVE_NONE)
+            td->ponder_move = ponder_from_tt<C>(td->best_move);
+
         if (threadPool.get_logUci())
         {
             show_uci_best(td);
@@ -58,32 +111,90 @@ void Search::iterative_deepening(ThreadData* td)
     PVariation pv;
     pv.length = 0;
     int  ply = 0;
+    int  stability = 0;     // nombre d'itérations sans changement du meilleur coup
+
+    std::vector<RootMove>& root_moves = td->root_moves;
+
+    // Position terminale : mat ou pat
+    if (root_moves.empty())
+    {
+        td->best_move  = Move::MOVE_NONE;
+        td->best_score = board.is_in_check<C>() ? -MATE : 0;
+        return;
+    }
+
+    // Nombre de lignes à chercher (MultiPV) : seule la thread principale
+    // construit les variations, les autres ne cherchent que la meilleure
+    td->multipv = (td->index == 0) ? std::min(static_cast<int>(root_moves.size()), threadPool.get_multiPV()) : 1;
 
     for (td->depth = 1; td->depth <= timer.getSearchDepth(); td->depth++)
     {
-        // Search position, using aspiration windows for higher depths
-        td->score = aspiration_window<C>(ply, pv, td);
+        for (RootMove& rm : root_moves)
+        {
+            rm.prev_score = rm.score;
+            rm.score      = -INFINITE;
+        }
+
+        // Chaque ligne est cherchée avec sa propre fenêtre ;
+        // les coups des lignes précédentes ne sont pas cherchés à la racine
+        for (td->pv_index = 0; td->pv_index < td->multipv; td->pv_index++)
+        {
+            // Search position, using aspiration windows for higher depths
+            aspiration_window<C>(ply, pv, td);
+
+            if (threadPool.is_stopped())
+                break;
+
+            // Le meilleur coup de cette ligne passe en tête des coups restants,
+            // puis les lignes déjà trouvées sont classées entre elles
+            std::stable_sort(root_moves.begin() + td->pv_index, root_moves.end(), root_move_order);
+            std::stable_sort(root_moves.begin(), root_moves.begin() + td->pv_index + 1, root_move_order);
+        }
+        td->pv_index = 0;
 
-        if (td->stopped)
+        if (threadPool.is_stopped())
             break;
 
+        const RootMove& best = root_moves[0];
+        td->score = best.score;
+
         // L'itération s'est terminée sans problème
         // On peut mettre à jour les infos UCI
         if (td->index == 0)
         {
-            bool uncertain = pv.line[0] != td->best_move;
+            // Stabilité du meilleur coup et chute du score
+            // depuis l'itération précédente
+            int score_drop = 0;
+            if (td->depth > 1)
+            {
+                stability  = (best.move == td->best_move) ? stability + 1 : 0;
+                score_drop = td->best_score - td->score;
+            }
+
+            // Part des noeuds consacrée au meilleur coup
+            double best_nodes = static_cast<double>(best.nodes) / std::max<U64>(1, td->nodes);
 
-            td->best_depth = td->depth;
-            td->best_move  = pv.line[0];
-            td->best_score = td->score;
+            td->best_depth  = td->depth;
+            td->best_move   = best.move;
+            td->best_score  = td->score;
+            td->ponder_move = best.pv.length > 1 ? best.pv.line[1] : Move::MOVE_NONE;
+
+            // Après "ponderhit", la pendule a été redémarrée :
+            // le temps écoulé doit être lu sur la nouvelle pendule
+            bool pondering = threadPool.is_pondering();
+            if (threadPool.control.ponderhit.exchange(false, std::memory_order_acquire))
+                timer = threadPool.get_ponder_timer();
 
             auto elapsed = timer.elapsedTime();
 
             if (threadPool.get_logUci())
-                show_uci_result(td, elapsed, pv);
+            {
+                for (int i = 0; i < td->multipv; i++)
+                    show_uci_result(td, elapsed, root_moves[i].score, root_moves[i].pv, i + 1);
+            }
 
             // If an iteration finishes after optimal time usage, stop the search
-            if (timer.finishOnThisDepth(elapsed, uncertain))
+            if (!pondering && timer.finishOnThisDepth(elapsed, stability, score_drop, best_nodes))
                 break;
 
             td->seldepth = 0;
@@ -102,13 +213,13 @@ int Search::aspiration_window(int ply, PVariation& pv, ThreadData* td)
     int alpha  = -INFINITE;
     int beta   = INFINITE;
     int depth  = td->depth;
-    int score  = td->score;
+    int score  = td->root_moves[td->pv_index].prev_score;   // score de la ligne à l'itération précédente
 
     const int initialWindow = 12;
     int delta = 16;
 
     // After a few depths use a previous result to form the window
-    if (depth >= 6)
+    if (depth >= 6 && score > -INFINITE)
     {
         alpha = std::max(score - initialWindow, -INFINITE);
         beta  = std::min(score + initialWindow, INFINITE);
@@ -116,9 +227,14 @@ int Search::aspiration_window(int ply, PVariation& pv, ThreadData* td)
 
     while (true)
     {
+        // Les scores d'une fenêtre précédente ne sont plus valables,
+        // y compris pour les coups non cherchés après une coupure
+        for (size_t i = td->pv_index; i < td->root_moves.size(); i++)
+            td->root_moves[i].score = -INFINITE;
+
         score = alpha_beta<C>(ply, alpha, beta, std::max(1, depth), pv, td);
 
-        if (td->stopped)
+        if (threadPool.is_stopped())
             break;
 
         // Search failed low, adjust window and reset depth
@@ -191,9 +307,9 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
         return board.evaluate();
 
     //  Time-out
-    if (td->stopped || check_limits(td))
+    if (threadPool.is_stopped() || check_limits(td))
     {
-        td->stopped = true;
+        threadPool.signal_stop();
         return 0;
     }
 
@@ -216,7 +332,7 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
     if (depth <= 0)
     {
         td->nodes--;
-        return (quiescence<C>(ply, alpha, beta, td));
+        return (quiescence<C>(ply, alpha, beta, 0, td));
     }
 
     if (!isRoot)
@@ -314,7 +430,7 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
     td->order.killer2[ply + 1] = Move::MOVE_NONE;
 
     //  Controle si on va pouvoir utiliser des techniques de coupe pre-move
-    int  score;
+    int  score = -INFINITE;
 
     if (!inCheck && !isRoot && !isPVNode && excluded_move==Move::MOVE_NONE)
     {
@@ -325,7 +441,7 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
         if (   depth <= 3
             && (static_eval + 200 * depth) <= alpha)
         {
-            score = quiescence<C>(ply, alpha, beta, td);
+            score = quiescence<C>(ply, alpha, beta, 0, td);
             if (score <= alpha)
             {
                 td->nodes--;
@@ -368,7 +484,7 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
             score = -alpha_beta<~C>(ply + 1, -beta, -beta + 1, depth - 1 - R, new_pv, td);
             board.undo_nullmove<C>();
 
-            if (td->stopped)
+            if (threadPool.is_stopped())
                 return 0;
 
             // Cutoff
@@ -393,7 +509,8 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
         {
             int threshold = beta + 200;
 
-            MovePicker movePicker(&board, order, Move::MOVE_NONE, Move::MOVE_NONE, Move::MOVE_NONE, Move::MOVE_NONE, true, 0);
+            MovePicker movePicker(&board, order, Move::MOVE_NONE, Move::MOVE_NONE, Move::MOVE_NONE, Move::MOVE_NONE,
+                                  Move::MOVE_NONE, Move::MOVE_NONE, true, 0);
             MOVE pbMove;
 
             while ( (pbMove = movePicker.next_move() ) != Move::MOVE_NONE )
@@ -402,7 +519,7 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
                 td->move[ply] = pbMove;
 
                 // See if a quiescence search beats pbBeta
-                int pbScore = -quiescence<~C>(ply+1, -threshold, -threshold+1, td);
+                int pbScore = -quiescence<~C>(ply+1, -threshold, -threshold+1, 0, td);
 
                 // If it did, do a proper search with reduced depth
                 if (pbScore >= threshold)
@@ -439,16 +556,24 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
     //  Génération des coups
     //------------------------------------------------------------------------------------
 
-    MOVE k1, k2, mc;
-    order->get_refutation_moves(C, ply, td->move[ply-1], k1, k2, mc);
+    // À la racine, on suit la liste des coups de la racine (voir next_root_move) :
+    // le MovePicker n'est construit qu'en dehors de la racine
+    std::optional<MovePicker> movePicker;
+    if (!isRoot)
+    {
+        MOVE k1, k2, mc;
+        order->get_refutation_moves(C, ply, td->move[ply-1], k1, k2, mc);
+
+        movePicker.emplace(&board, order, tt_move, k1, k2, mc, td->move[ply-1], td->move[ply-2], false, 0);
+    }
 
-    MovePicker movePicker(&board, order, tt_move, k1, k2, mc, false, 0);
     MOVE move;
     const int old_alpha = alpha;
     int moveCount = 0;
+    int root_index = td->pv_index;
 
     // Boucle sur tous les coups
-    while ( (move = movePicker.next_move() ) != Move::MOVE_NONE )
+    while ( (move = isRoot ? next_root_move(td, root_index) : movePicker->next_move() ) != Move::MOVE_NONE )
     {
         // don't search this during singular
         if (move == excluded_move)
@@ -514,6 +639,9 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
 
 #endif
 
+        // noeuds consacrés à ce coup (racine)
+        const U64 nodes_before = td->nodes;
+
         // execute current move
         board.make_move<C>(move);
         td->move[ply] = move;
@@ -547,7 +675,9 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
             // Reduce more for the side that last null moved
             //           r += sideToMove == thread->nullMover;
             // Adjust reduction by move history (-2 to +2)
-            //           r -= histScore / 6000;
+            int histScore = order->get_history(C, move)
+                          + order->get_continuation(C, td->move[ply-1], td->move[ply-2], move);
+            R -= std::clamp(histScore / 8192, -2, 2);
 
             // Depth after reductions, avoiding going straight to quiescence
             int lmrDepth = CLAMP(newDepth - R, 1, newDepth - 1);
@@ -574,10 +704,30 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
         // retract current move
         board.undo_move<C>();
 
+        if (isRoot)
+            td->root_moves[root_index - 1].nodes += td->nodes - nodes_before;
+
         //  Time-out
-        if (td->stopped)
+        if (threadPool.is_stopped())
             return 0;
 
+        // Résultat du coup de la racine : seuls le premier coup
+        // et ceux qui améliorent alpha ont un score exploitable ;
+        // les autres ne doivent pas garder un score plus ancien
+        if (isRoot)
+        {
+            RootMove& rm = td->root_moves[root_index - 1];
+            if (moveCount == 1 || score > alpha)
+            {
+                rm.score = score;
+                update_pv(rm.pv, new_pv, move);
+            }
+            else
+            {
+                rm.score = -INFINITE;
+            }
+        }
+
         // On a trouvé un nouveau meilleur coup
         if (score > best_score)
         {
@@ -604,11 +754,16 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
                     // Update Killers
                     if (isQuiet)
                     {
-                        order->update_history(C, move, depth);
+                        order->update_quiet_histories(C, td->move[ply-1], td->move[ply-2], move,
+                                                      quietsTried, quietsPlayed, depth);
                         order->update_killers(ply, move);
                         order->update_counter(C, ply, td->move[ply-1] , move);
                     }
-                    if (excluded_move==Move::MOVE_NONE)
+                    else
+                    {
+                        order->update_capture_history(C, move, OrderInfo::history_bonus(depth));
+                    }
+                    if (excluded_move==Move::MOVE_NONE && !(isRoot && td->pv_index > 0))
                         transpositionTable.store(board.hash, move, score, static_eval, BOUND_LOWER, depth, ply);
                     return score;
                 }
@@ -632,7 +787,8 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
     // don't let our score inflate too high (tb)
     best_score = std::min(best_score, max_score);
 
-    if (excluded_move==Move::MOVE_NONE && !td->stopped)
+    // Avec des coups exclus à la racine (MultiPV), le score n'est pas celui de la position
+    if (excluded_move==Move::MOVE_NONE && !(isRoot && td->pv_index > 0) && !threadPool.is_stopped())
     {
         //  si on est ici, c'est que l'on a trouvé au moins 1 coup
         //  et de plus : score < beta
@@ -645,6 +801,38 @@ int Search::alpha_beta(int ply, int alpha, int beta, int depth, PVariation& pv,
     return best_score;
 }
 
+//======================================================
+//! \brief  Recherche dans la table du coup de l'adversaire
+//! qui suit le meilleur coup, lorsque la variation
+//! principale n'en contient pas.
+//------------------------------------------------------
+template<Color C>
+MOVE Search::ponder_from_tt(MOVE best)
+{
+    MOVE  move  = Move::MOVE_NONE;
+    Score score, eval;
+    int   flag, depth;
+
+    board.make_move<C>(best);
+
+    if (transpositionTable.probe(board.hash, 0, move, score, eval, flag, depth))
+    {
+        MoveList ml;
+        board.legal_moves<~C>(ml);
+
+        bool legal = false;
+        for (size_t n = 0; n < ml.count; n++)
+            if (ml.moves[n] == move)
+                legal = true;
+        if (!legal)
+            move = Move::MOVE_NONE;
+    }
+
+    board.undo_move<C>();
+
+    return move;
+}
+
 template void Search::think<WHITE>(const Board &m_board, const Timer &m_timer, int _index);
 template void Search::think<BLACK>(const Board &m_board, const Timer &m_timer, int _index);
 
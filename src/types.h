@@ -110,5 +110,15 @@ struct PVariation {
     int  length;
 };
 
+//! \brief  Coup de la racine, avec les résultats de sa recherche
+struct RootMove {
+    MOVE       move;
+    int        score;       // score à l'itération courante (-INFINITE : pas de score)
+    int        prev_score;  // score à l'itération précédente
+    U64        nodes;       // noeuds consacrés à ce coup
+    int        tb_rank;     // classement Syzygy : de -2 (perte) à +2 (gain), 0 si inconnu
+    PVariation pv;          // variation commençant par ce coup
+};
+
 #endif // TYPES_H
 
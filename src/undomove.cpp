@@ -1,6 +1,7 @@
 #include "Board.h"
 #include "Square.h"
 #include "Move.h"
+#include "NNUE.h"
 
 //=============================================================
 //! \brief  Enlève un coup
@@ -10,6 +11,11 @@ template <Color C> constexpr void Board::undo_move() noexcept
     // Swap sides
     side_to_move = ~side_to_move;
 
+#if defined USE_NNUE
+    if (accumulators != nullptr)
+        accumulators->pop();
+#endif
+
     gamemove_counter--;
     
     const auto &move    = game_history[gamemove_counter].move;
@@ -37,6 +43,10 @@ template <Color C> constexpr void Board::undo_move() noexcept
     // Castling
     castling = game_history[gamemove_counter].castling;
 
+    // Matériel et position
+    psqt    = game_history[gamemove_counter].psqt;
+    mat_key = game_history[gamemove_counter].mat_key;
+
 #if defined USE_HASH
     hash      = game_history[gamemove_counter].hash;
     pawn_hash = game_history[gamemove_counter].pawn_hash;
@@ -205,6 +215,11 @@ template <Color C> constexpr void Board::undo_nullmove() noexcept
     // Swap sides
     side_to_move = ~side_to_move;
 
+#if defined USE_NNUE
+    if (accumulators != nullptr)
+        accumulators->pop();
+#endif
+
     gamemove_counter--;
 
     // En passant
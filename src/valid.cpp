@@ -21,6 +21,19 @@ bool Board::valid() const noexcept
         return false;
     }
 #endif
+    Score psqt_1;
+    U64   key_1;
+    calculate_psqt(psqt_1, key_1);
+    if (psqt != psqt_1)
+    {
+        std::cout << "erreur psqt" << std::endl;
+        return false;
+    }
+    if (mat_key != key_1)
+    {
+        std::cout << "erreur mat_key" << std::endl;
+        return false;
+    }
     if (ep() != NO_SQUARE) {
         if (turn() == Color::WHITE && SQ::rank(ep()) != 5) {
             std::cout << "erreur 1" << std::endl;